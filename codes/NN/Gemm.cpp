@@ -0,0 +1,221 @@
+#include "Gemm.hpp"
+#include <algorithm>
+#include <cmath>
+
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__) && !defined(NN_SCALAR_GEMM)
+#define NN_GEMM_AVX2 1
+#include <immintrin.h>
+#endif
+
+namespace ml {
+
+namespace {
+
+// Register tile (MR×NR) and cache blocks: a KC×NR panel of B stays in L1,
+// an MC×KC block of A in L2, a KC×NC block of B in L3
+constexpr int MR = 6;
+constexpr int NR = 8;
+constexpr int MC = 96;
+constexpr int KC = 256;
+constexpr int NC = 2048;
+
+// Packing buffers, one pair per thread, allocated on first use
+struct PackBuffers {
+    double *a = detail::alloc_doubles(static_cast<std::size_t>(MC) * KC);
+    double *b = detail::alloc_doubles(static_cast<std::size_t>(KC) * NC);
+    ~PackBuffers() {
+        detail::free_doubles(a);
+        detail::free_doubles(b);
+    }
+};
+
+// Rows [i0, i0+mc) and columns [p0, p0+kc) of op(A), as MR-row panels
+// stored column by column; rows past m are zero
+void pack_a(bool trans, const double *A, int lda, int m, int i0, int mc, int p0, int kc, double *out) {
+    for (int ir = 0; ir < mc; ir += MR) {
+        for (int p = 0; p < kc; ++p) {
+            for (int ii = 0; ii < MR; ++ii) {
+                int i = i0 + ir + ii;
+                *out++ = i < m ? (trans ? A[static_cast<std::size_t>(p0 + p) * lda + i]
+                                        : A[static_cast<std::size_t>(i) * lda + p0 + p])
+                               : 0.0;
+            }
+        }
+    }
+}
+
+// Rows [p0, p0+kc) and columns [j0, j0+nc) of op(B), as NR-column panels
+// stored row by row; columns past n are zero
+void pack_b(bool trans, const double *B, int ldb, int n, int p0, int kc, int j0, int nc, double *out) {
+    for (int jr = 0; jr < nc; jr += NR) {
+        for (int p = 0; p < kc; ++p) {
+            for (int jj = 0; jj < NR; ++jj) {
+                int j = j0 + jr + jj;
+                *out++ = j < n ? (trans ? B[static_cast<std::size_t>(j) * ldb + p0 + p]
+                                        : B[static_cast<std::size_t>(p0 + p) * ldb + j])
+                               : 0.0;
+            }
+        }
+    }
+}
+
+// tile = packed A panel (MR×kc) * packed B panel (kc×NR)
+void kernel_scalar(int kc, const double *a, const double *b, double *tile) {
+    double acc[MR][NR] = {};
+    for (int p = 0; p < kc; ++p) {
+        for (int i = 0; i < MR; ++i)
+            for (int j = 0; j < NR; ++j)
+                acc[i][j] += a[i] * b[j];
+        a += MR;
+        b += NR;
+    }
+    for (int i = 0; i < MR; ++i)
+        for (int j = 0; j < NR; ++j)
+            tile[i * NR + j] = acc[i][j];
+}
+
+#ifdef NN_GEMM_AVX2
+// 12 accumulators (6 rows × 2 registers of 4) + 2 B loads + 1 broadcast
+__attribute__((target("avx2,fma")))
+void kernel_avx2(int kc, const double *a, const double *b, double *tile) {
+    __m256d c00 = _mm256_setzero_pd(), c01 = _mm256_setzero_pd();
+    __m256d c10 = _mm256_setzero_pd(), c11 = _mm256_setzero_pd();
+    __m256d c20 = _mm256_setzero_pd(), c21 = _mm256_setzero_pd();
+    __m256d c30 = _mm256_setzero_pd(), c31 = _mm256_setzero_pd();
+    __m256d c40 = _mm256_setzero_pd(), c41 = _mm256_setzero_pd();
+    __m256d c50 = _mm256_setzero_pd(), c51 = _mm256_setzero_pd();
+    for (int p = 0; p < kc; ++p) {
+        __m256d b0 = _mm256_load_pd(b);
+        __m256d b1 = _mm256_load_pd(b + 4);
+        __m256d ai;
+        ai = _mm256_broadcast_sd(a + 0); c00 = _mm256_fmadd_pd(ai, b0, c00); c01 = _mm256_fmadd_pd(ai, b1, c01);
+        ai = _mm256_broadcast_sd(a + 1); c10 = _mm256_fmadd_pd(ai, b0, c10); c11 = _mm256_fmadd_pd(ai, b1, c11);
+        ai = _mm256_broadcast_sd(a + 2); c20 = _mm256_fmadd_pd(ai, b0, c20); c21 = _mm256_fmadd_pd(ai, b1, c21);
+        ai = _mm256_broadcast_sd(a + 3); c30 = _mm256_fmadd_pd(ai, b0, c30); c31 = _mm256_fmadd_pd(ai, b1, c31);
+        ai = _mm256_broadcast_sd(a + 4); c40 = _mm256_fmadd_pd(ai, b0, c40); c41 = _mm256_fmadd_pd(ai, b1, c41);
+        ai = _mm256_broadcast_sd(a + 5); c50 = _mm256_fmadd_pd(ai, b0, c50); c51 = _mm256_fmadd_pd(ai, b1, c51);
+        a += MR;
+        b += NR;
+    }
+    _mm256_store_pd(tile + 0 * NR, c00); _mm256_store_pd(tile + 0 * NR + 4, c01);
+    _mm256_store_pd(tile + 1 * NR, c10); _mm256_store_pd(tile + 1 * NR + 4, c11);
+    _mm256_store_pd(tile + 2 * NR, c20); _mm256_store_pd(tile + 2 * NR + 4, c21);
+    _mm256_store_pd(tile + 3 * NR, c30); _mm256_store_pd(tile + 3 * NR + 4, c31);
+    _mm256_store_pd(tile + 4 * NR, c40); _mm256_store_pd(tile + 4 * NR + 4, c41);
+    _mm256_store_pd(tile + 5 * NR, c50); _mm256_store_pd(tile + 5 * NR + 4, c51);
+}
+
+bool cpu_has_avx2() {
+    __builtin_cpu_init();   // runs from a static initializer
+    return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+}
+#endif
+
+using Kernel = void (*)(int, const double *, const double *, double *);
+
+Kernel select_kernel() {
+#ifdef NN_GEMM_AVX2
+    if (cpu_has_avx2()) return kernel_avx2;
+#endif
+    return kernel_scalar;
+}
+
+const Kernel kernel = select_kernel();
+
+double activate(Activation act, double x) {
+    switch (act) {
+        case Activation::Sigmoid: return 1.0 / (1.0 + std::exp(-x));
+        default:                  return x;
+    }
+}
+
+// Writes an mr×nr corner of a finished tile into C. The first K block
+// scales C by beta (or overwrites it), later ones accumulate; after the
+// last one the epilogue runs while the tile is still in L1.
+void store_tile(const double *tile, int mr, int nr, double alpha, double beta,
+                bool first_block, bool last_block, const Epilogue &epilogue,
+                double *C, int ldc, int j0) {
+    for (int i = 0; i < mr; ++i) {
+        double *c = C + static_cast<std::size_t>(i) * ldc;
+        const double *t = tile + i * NR;
+        if (!first_block)     for (int j = 0; j < nr; ++j) c[j] += alpha * t[j];
+        else if (beta == 0.0) for (int j = 0; j < nr; ++j) c[j] = alpha * t[j];
+        else                  for (int j = 0; j < nr; ++j) c[j] = beta * c[j] + alpha * t[j];
+
+        if (!last_block) continue;
+        if (epilogue.bias)
+            for (int j = 0; j < nr; ++j) c[j] += epilogue.bias[j0 + j];
+        if (epilogue.act != Activation::None)
+            for (int j = 0; j < nr; ++j) c[j] = activate(epilogue.act, c[j]);
+    }
+}
+
+} // namespace
+
+void gemm(bool trans_a, bool trans_b, int m, int n, int k,
+          double alpha, const double *A, int lda,
+          const double *B, int ldb,
+          double beta, double *C, int ldc,
+          const Epilogue &epilogue) {
+    if (m <= 0 || n <= 0) return;
+
+    static thread_local PackBuffers pack;
+    alignas(64) double tile[MR * NR];
+
+    // k == 0: no product, only the beta scaling and the epilogue
+    if (k <= 0) {
+        std::fill(tile, tile + MR * NR, 0.0);
+        for (int i = 0; i < m; i += MR)
+            for (int j = 0; j < n; j += NR)
+                store_tile(tile, std::min(MR, m - i), std::min(NR, n - j), alpha, beta, true, true,
+                           epilogue, C + static_cast<std::size_t>(i) * ldc + j, ldc, j);
+        return;
+    }
+
+    for (int jc = 0; jc < n; jc += NC) {
+        int nc = std::min(NC, n - jc);
+        for (int pc = 0; pc < k; pc += KC) {
+            int kc = std::min(KC, k - pc);
+            bool first_block = pc == 0, last_block = pc + kc == k;
+            pack_b(trans_b, B, ldb, n, pc, kc, jc, nc, pack.b);
+
+            for (int ic = 0; ic < m; ic += MC) {
+                int mc = std::min(MC, m - ic);
+                pack_a(trans_a, A, lda, m, ic, mc, pc, kc, pack.a);
+
+                for (int jr = 0; jr < nc; jr += NR) {
+                    const double *b_panel = pack.b + static_cast<std::size_t>(jr) * kc;
+                    for (int ir = 0; ir < mc; ir += MR) {
+                        kernel(kc, pack.a + static_cast<std::size_t>(ir) * kc, b_panel, tile);
+                        int i = ic + ir, j = jc + jr;
+                        store_tile(tile, std::min(MR, m - i), std::min(NR, n - j), alpha, beta,
+                                   first_block, last_block, epilogue,
+                                   C + static_cast<std::size_t>(i) * ldc + j, ldc, j);
+                    }
+                }
+            }
+        }
+    }
+}
+
+void gemm(bool trans_a, const Matrix &A, bool trans_b, const Matrix &B,
+          double alpha, double beta, Matrix &C, const Epilogue &epilogue) {
+    int m = trans_a ? A.cols : A.rows;
+    int k = trans_a ? A.rows : A.cols;
+    int kb = trans_b ? B.cols : B.rows;
+    int n = trans_b ? B.rows : B.cols;
+    if (k != kb) throw std::invalid_argument("Inner dims must match");
+    if (C.rows != m || C.cols != n) throw std::invalid_argument("Output dims must match");
+    gemm(trans_a, trans_b, m, n, k, alpha, A.data, A.stride, B.data, B.stride,
+         beta, C.data, C.stride, epilogue);
+}
+
+bool gemm_uses_simd() {
+#ifdef NN_GEMM_AVX2
+    return kernel == kernel_avx2;
+#else
+    return false;
+#endif
+}
+
+} // namespace ml
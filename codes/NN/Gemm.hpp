@@ -0,0 +1,43 @@
+#ifndef GEMM_HPP
+#define GEMM_HPP
+
+#include "Matrix.hpp"
+
+namespace ml {
+
+// Applied to each element of C once the product is complete
+enum class Activation { None, Sigmoid };
+
+// Fused GEMM epilogue: C(i, j) = act(C(i, j) + bias[j])
+struct Epilogue {
+    const double *bias = nullptr;   // length n, or nullptr for no bias
+    Activation act = Activation::None;
+};
+
+/**
+ * C = alpha * op(A) * op(B) + beta * C, then the epilogue.
+ * op(X) is X or its transpose; all matrices are row-major with the given
+ * row strides. op(A) is m×k, op(B) is k×n, C is m×n. With beta == 0, C
+ * is not read.
+ *
+ * Cache-blocked: panels of op(A) and op(B) are packed into contiguous
+ * buffers and multiplied by a 6×8 register-tiled kernel, AVX2/FMA when
+ * the CPU has it (checked at run time), scalar otherwise.
+ */
+void gemm(bool trans_a, bool trans_b, int m, int n, int k,
+          double alpha, const double *A, int lda,
+          const double *B, int ldb,
+          double beta, double *C, int ldc,
+          const Epilogue &epilogue = Epilogue());
+
+/// Same on Matrix objects; dimensions are checked
+void gemm(bool trans_a, const Matrix &A, bool trans_b, const Matrix &B,
+          double alpha, double beta, Matrix &C,
+          const Epilogue &epilogue = Epilogue());
+
+/// True when gemm runs the AVX2/FMA kernel
+bool gemm_uses_simd();
+
+} // namespace ml
+
+#endif // GEMM_HPP
@@ -5,6 +5,38 @@
 #include <stdexcept>
 #include <iomanip>
 #include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <cassert>
+#include <new>
+#include <utility>
+
+// ----------- Aligned storage -----------
+// Vector and Matrix keep their elements in one 64-byte-aligned block
+// (a cache line, and a whole number of AVX registers). Blocks are padded
+// to a multiple of 8 doubles and the padding is zero.
+namespace detail {
+
+constexpr std::size_t ALIGNMENT = 64;
+constexpr int PAD = static_cast<int>(ALIGNMENT / sizeof(double));
+
+inline int padded(int n) {
+    return (n + PAD - 1) / PAD * PAD;
+}
+
+inline double* alloc_doubles(std::size_t n) {
+    std::size_t bytes = (n * sizeof(double) + ALIGNMENT - 1) / ALIGNMENT * ALIGNMENT;
+    void *p = std::aligned_alloc(ALIGNMENT, bytes);
+    if (!p) throw std::bad_alloc();
+    std::memset(p, 0, bytes);
+    return static_cast<double*>(p);
+}
+
+inline void free_doubles(double *p) {
+    std::free(p);
+}
+
+} // namespace detail
 
 // ----------- Vector Class -----------
 class Vector {
@@ -16,31 +48,47 @@ public:
     Vector(): size(0), data(nullptr) {}
 
     // Construct a vector of length s, initialized to 0.0
-    Vector(int s): size(s), data(new double[s]()) {
+    Vector(int s): size(s), data(nullptr) {
         if (s <= 0) throw std::invalid_argument("Vector size must be positive");
+        data = detail::alloc_doubles(detail::padded(s));
     }
 
     // Copy constructor: deep copy
-    Vector(const Vector &other): size(other.size),
-                                 data(new double[other.size]) {
-        for (int i = 0; i < size; ++i)
-            data[i] = other.data[i];
+    Vector(const Vector &other): size(other.size), data(nullptr) {
+        if (size > 0) {
+            data = detail::alloc_doubles(detail::padded(size));
+            std::memcpy(data, other.data, sizeof(double) * size);
+        }
+    }
+
+    // Move constructor: takes the buffer, leaves other empty
+    Vector(Vector &&other) noexcept: size(other.size), data(other.data) {
+        other.size = 0;
+        other.data = nullptr;
     }
 
     // Copy assignment: deep copy with self-assign guard
     Vector& operator=(const Vector &other) {
         if (this == &other) return *this;
-        delete[] data;
-        size = other.size;
-        data = new double[size];
-        for (int i = 0; i < size; ++i)
-            data[i] = other.data[i];
+        Vector copy(other);
+        swap(copy);
+        return *this;
+    }
+
+    // Move assignment
+    Vector& operator=(Vector &&other) noexcept {
+        swap(other);
         return *this;
     }
 
     // Destructor: free memory
     ~Vector() {
-        delete[] data;
+        detail::free_doubles(data);
+    }
+
+    void swap(Vector &other) noexcept {
+        std::swap(size, other.size);
+        std::swap(data, other.data);
     }
 
     // Element access (with bounds checking)
@@ -53,6 +101,16 @@ public:
         return data[i];
     }
 
+    // Element access for hot loops: checked only in debug builds
+    double& operator[](int i) {
+        assert(i >= 0 && i < size);
+        return data[i];
+    }
+    double operator[](int i) const {
+        assert(i >= 0 && i < size);
+        return data[i];
+    }
+
     // Dot product
     double dot(const Vector &B) const {
         if (size != B.size) throw std::invalid_argument("Vector size mismatch in dot");
@@ -93,70 +151,101 @@ public:
 class Matrix {
 public:
     int rows, cols;
-    Vector **colData;   // column-major: array of pointers to Vectors
+    int stride;      // doubles from one row to the next: cols rounded up to 8
+    double *data;    // row-major: element (i, j) at data[i * stride + j]
 
     // Construct a rows×cols matrix of zeros
-    Matrix(int r, int c): rows(r), cols(c), colData(new Vector*[c]) {
+    Matrix(int r, int c): rows(r), cols(c), stride(0), data(nullptr) {
         if (r <= 0 || c <= 0) throw std::invalid_argument("Matrix size must be positive");
-        for (int j = 0; j < cols; ++j)
-            colData[j] = new Vector(rows);
+        stride = detail::padded(c);
+        data = detail::alloc_doubles(static_cast<std::size_t>(rows) * stride);
     }
 
     // Copy constructor: deep copy
-    Matrix(const Matrix &M): rows(M.rows), cols(M.cols),
-                             colData(new Vector*[M.cols]) {
-        for (int j = 0; j < cols; ++j)
-            colData[j] = new Vector(*M.colData[j]);
+    Matrix(const Matrix &M): rows(M.rows), cols(M.cols), stride(M.stride), data(nullptr) {
+        if (M.data) {
+            std::size_t n = static_cast<std::size_t>(rows) * stride;
+            data = detail::alloc_doubles(n);
+            std::memcpy(data, M.data, sizeof(double) * n);
+        }
     }
 
-    // Copy assignment: deep copy with cleanup
+    // Move constructor: takes the buffer, leaves M empty (0×0)
+    Matrix(Matrix &&M) noexcept: rows(M.rows), cols(M.cols), stride(M.stride), data(M.data) {
+        M.rows = M.cols = M.stride = 0;
+        M.data = nullptr;
+    }
+
+    // Copy assignment: deep copy with self-assign guard
     Matrix& operator=(const Matrix &M) {
         if (this == &M) return *this;
-        for (int j = 0; j < cols; ++j) delete colData[j];
-        delete[] colData;
-        rows = M.rows;  cols = M.cols;
-        colData = new Vector*[cols];
-        for (int j = 0; j < cols; ++j)
-            colData[j] = new Vector(*M.colData[j]);
+        Matrix copy(M);
+        swap(copy);
+        return *this;
+    }
+
+    // Move assignment
+    Matrix& operator=(Matrix &&M) noexcept {
+        swap(M);
         return *this;
     }
 
     // Destructor
     ~Matrix() {
-        for (int j = 0; j < cols; ++j) delete colData[j];
-        delete[] colData;
+        detail::free_doubles(data);
+    }
+
+    void swap(Matrix &M) noexcept {
+        std::swap(rows, M.rows);
+        std::swap(cols, M.cols);
+        std::swap(stride, M.stride);
+        std::swap(data, M.data);
     }
 
     // Element access (i=row, j=col)
     double& operator()(int i, int j) {
         if (i<0||i>=rows||j<0||j>=cols) throw std::out_of_range("Matrix index out of range");
-        return colData[j]->data[i];
+        return data[static_cast<std::size_t>(i) * stride + j];
     }
     double operator()(int i, int j) const {
         if (i<0||i>=rows||j<0||j>=cols) throw std::out_of_range("Matrix index out of range");
-        return colData[j]->data[i];
+        return data[static_cast<std::size_t>(i) * stride + j];
+    }
+
+    // Row i for hot loops, M[i][j]: checked only in debug builds.
+    // Every row starts on a 64-byte boundary.
+    double* operator[](int i) {
+        assert(i >= 0 && i < rows);
+        return data + static_cast<std::size_t>(i) * stride;
+    }
+    const double* operator[](int i) const {
+        assert(i >= 0 && i < rows);
+        return data + static_cast<std::size_t>(i) * stride;
     }
 
     // Matrix multiplication
     Matrix operator*(const Matrix &B) const {
         if (cols != B.rows) throw std::invalid_argument("Inner dims must match");
         Matrix C(rows, B.cols);
-        for (int j = 0; j < B.cols; ++j)
-            for (int i = 0; i < rows; ++i) {
-                double sum = 0.0;
-                for (int k = 0; k < cols; ++k)
-                    sum += colData[k]->data[i] * B.colData[j]->data[k];
-                C.colData[j]->data[i] = sum;
+        // i-k-j: the inner loop runs along rows of B and C
+        for (int i = 0; i < rows; ++i) {
+            double *c = C[i];
+            for (int k = 0; k < cols; ++k) {
+                double a = (*this)[i][k];
+                const double *b = B[k];
+                for (int j = 0; j < B.cols; ++j)
+                    c[j] += a * b[j];
             }
+        }
         return C;
     }
 
     // Scalar multiply: A * k
     Matrix operator*(double k) const {
         Matrix C(rows, cols);
-        for (int j = 0; j < cols; ++j)
-            for (int i = 0; i < rows; ++i)
-                C.colData[j]->data[i] = colData[j]->data[i] * k;
+        for (int i = 0; i < rows; ++i)
+            for (int j = 0; j < cols; ++j)
+                C[i][j] = (*this)[i][j] * k;
         return C;
     }
     // Scalar multiply: k * A
@@ -169,7 +258,7 @@ public:
         for (int i = 0; i < rows; ++i) {
             for (int j = 0; j < cols; ++j)
                 std::cout << std::fixed << std::setprecision(4)
-                          << colData[j]->data[i] << " ";
+                          << (*this)[i][j] << " ";
             std::cout << "\n";
         }
     }
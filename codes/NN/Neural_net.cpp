@@ -1,6 +1,9 @@
 #include "Neural_net.hpp"
+#include "Gemm.hpp"
+#include <algorithm>
 #include <cstdlib>
 #include <ctime>
+#include <vector>
 
 namespace ml {
 
@@ -30,10 +33,8 @@ NeuralNetwork::NeuralNetwork(int in_dim, int hidden_layers,
         
         for (int i = 0; i < Rin; ++i)
             for (int j = 0; j < Rout; ++j)
-                (*W[l])(i, j) = 2.0 * (std::rand() / (double)RAND_MAX) - 1.0;
-        
-        for (int j = 0; j < Rout; ++j)
-            (*b[l])(j) = 0.0;
+                (*W[l])[i][j] = 2.0 * (std::rand() / (double)RAND_MAX) - 1.0;
+        // biases start at zero (new Vectors are zeroed)
     }
 }
 
@@ -57,14 +58,18 @@ Vector NeuralNetwork::forward(const Vector &input) {
     
     for (int l = 0; l < num_layers - 1; ++l) {
         int Rout = layer_sizes[l+1];
-        A[l+1] = Vector(Rout); // allocate next layer
+        A[l+1] = *b[l]; // next layer starts at the bias
         
-        for (int j = 0; j < Rout; ++j) {
-            double sum = (*b[l])(j);
-            for (int i = 0; i < layer_sizes[l]; ++i)
-                sum += A[l](i) * (*W[l])(i, j);
-            A[l+1](j) = sigmoid(sum);
+        // row i of W[l] is contiguous: sweep it once per input
+        double *out = A[l+1].data;
+        for (int i = 0; i < layer_sizes[l]; ++i) {
+            double a = A[l][i];
+            const double *w = (*W[l])[i];
+            for (int j = 0; j < Rout; ++j)
+                out[j] += a * w[j];
         }
+        for (int j = 0; j < Rout; ++j)
+            out[j] = sigmoid(out[j]);
     }
     
     Vector output = A[num_layers - 1]; // copy result
@@ -76,97 +81,86 @@ Vector NeuralNetwork::forward(const Vector &input) {
 void NeuralNetwork::train_batch(const Vector *inputs,
                                const Vector *targets,
                                int M, double lr) {
-    int L = num_layers - 1;
+    // gather the samples as rows and train on the whole batch at once
+    Matrix X(M, layer_sizes[0]);
+    Matrix Y(M, layer_sizes[num_layers - 1]);
+    for (int k = 0; k < M; ++k) {
+        if (inputs[k].size != X.cols || targets[k].size != Y.cols)
+            throw std::invalid_argument("Sample size does not match the network");
+        std::copy(inputs[k].data, inputs[k].data + X.cols, X[k]);
+        std::copy(targets[k].data, targets[k].data + Y.cols, Y[k]);
+    }
+    train_batch(X, Y, lr);
+}
+
+// Forward propagate M samples, one per row
+Matrix NeuralNetwork::forward_batch(const Matrix &X) {
+    if (X.cols != layer_sizes[0]) throw std::invalid_argument("Input size does not match the network");
     
-    // 1) allocate gradient accumulators
-    Matrix **gradW = new Matrix*[L];
-    Vector **gradb = new Vector*[L];
+    Matrix A = X;
+    for (int l = 0; l < num_layers - 1; ++l) {
+        // A·W[l], then + b[l] and sigmoid in the GEMM epilogue
+        Matrix next(X.rows, layer_sizes[l+1]);
+        gemm(false, A, false, *W[l], 1.0, 0.0, next, {b[l]->data, Activation::Sigmoid});
+        A = std::move(next);
+    }
+    return A;
+}
+
+// Train on a batch given as matrices: every step is a matrix-matrix product
+void NeuralNetwork::train_batch(const Matrix &X, const Matrix &Y, double lr) {
+    int L = num_layers - 1;
+    int M = X.rows;
+    if (X.cols != layer_sizes[0] || Y.cols != layer_sizes[L] || Y.rows != M)
+        throw std::invalid_argument("Batch size does not match the network");
     
+    // 1) forward: A[l] holds the activations of layer l+1, M × layer_sizes[l+1]
+    std::vector<Matrix> A;
+    A.reserve(L);
+    auto input = [&](int l) -> const Matrix& { return l == 0 ? X : A[l-1]; };
     for (int l = 0; l < L; ++l) {
-        gradW[l] = new Matrix(layer_sizes[l], layer_sizes[l+1]);
-        gradb[l] = new Vector(layer_sizes[l+1]);
-        
-        // zero-init
-        for (int i = 0; i < layer_sizes[l]; ++i)
-            for (int j = 0; j < layer_sizes[l+1]; ++j)
-                (*gradW[l])(i,j) = 0.0;
-        
-        for (int j = 0; j < layer_sizes[l+1]; ++j)
-            (*gradb[l])(j) = 0.0;
+        A.emplace_back(M, layer_sizes[l+1]);
+        gemm(false, input(l), false, *W[l], 1.0, 0.0, A[l], {b[l]->data, Activation::Sigmoid});
     }
     
-    // 2) loop over each sample
+    // 2) backward: delta[l] has the shape of A[l]
+    std::vector<Matrix> delta;
+    delta.reserve(L);
+    for (int l = 0; l < L; ++l)
+        delta.emplace_back(M, layer_sizes[l+1]);
+    
+    // output delta
     for (int k = 0; k < M; ++k) {
-        // a) forward on sample k
-        Vector *A = new Vector[static_cast<size_t>(num_layers)];
-        A[0] = inputs[k];
-        
-        for (int l = 0; l < L; ++l) {
-            int Rout = layer_sizes[l+1];
-            A[l+1] = Vector(Rout);
-            
-            for (int j = 0; j < Rout; ++j) {
-                double sum = (*b[l])(j);
-                for (int i = 0; i < layer_sizes[l]; ++i)
-                    sum += A[l](i) * (*W[l])(i, j);
-                A[l+1](j) = sigmoid(sum);
-            }
-        }
-        
-        // b) backward: compute deltas
-        Vector *delta = new Vector[L];
-        
-        // output delta
-        delta[L-1] = Vector(layer_sizes[L]);
-        for (int j = 0; j < layer_sizes[L]; ++j) {
-            double err = targets[k](j) - A[L](j);
-            delta[L-1](j) = err * dsigmoid(A[L](j));
-        }
-        
-        // hidden deltas
-        for (int l = L-2; l >= 0; --l) {
-            delta[l] = Vector(layer_sizes[l+1]);
-            for (int j = 0; j < layer_sizes[l+1]; ++j) {
-                double err = 0.0;
-                for (int m = 0; m < layer_sizes[l+2]; ++m)
-                    err += delta[l+1](m) * (*W[l+1])(j, m);
-                delta[l](j) = err * dsigmoid(A[l+1](j));
-            }
-        }
-        
-        // c) accumulate gradients
-        for (int l = 0; l < L; ++l) {
-            for (int i = 0; i < layer_sizes[l]; ++i)
-                for (int j = 0; j < layer_sizes[l+1]; ++j)
-                    (*gradW[l])(i,j) += delta[l](j) * A[l](i);
-            
-            for (int j = 0; j < layer_sizes[l+1]; ++j)
-                (*gradb[l])(j) += delta[l](j);
-        }
-        
-        delete[] A;
-        delete[] delta;
+        const double *y = Y[k], *out = A[L-1][k];
+        double *d = delta[L-1][k];
+        for (int j = 0; j < layer_sizes[L]; ++j)
+            d[j] = (y[j] - out[j]) * dsigmoid(out[j]);
     }
     
-    // 3) apply averaged gradients
-    for (int l = 0; l < L; ++l) {
-        double factor = lr / M;
-        for (int i = 0; i < layer_sizes[l]; ++i)
+    // hidden deltas: delta[l+1]·W[l+1]ᵀ, scaled by the sigmoid slope
+    for (int l = L-2; l >= 0; --l) {
+        gemm(false, delta[l+1], true, *W[l+1], 1.0, 0.0, delta[l]);
+        for (int k = 0; k < M; ++k) {
+            const double *a = A[l][k];
+            double *d = delta[l][k];
             for (int j = 0; j < layer_sizes[l+1]; ++j)
-                (*W[l])(i,j) += factor * (*gradW[l])(i,j);
-        
-        for (int j = 0; j < layer_sizes[l+1]; ++j)
-            (*b[l])(j) += factor * (*gradb[l])(j);
+                d[j] *= dsigmoid(a[j]);
+        }
     }
     
-    // 4) cleanup
+    // 3) apply averaged gradients: W[l] += lr/M · input(l)ᵀ·delta[l]
+    //    straight into the weights (beta = 1), once every delta is known
+    double factor = lr / M;
     for (int l = 0; l < L; ++l) {
-        delete gradW[l];
-        delete gradb[l];
+        gemm(true, input(l), false, delta[l], factor, 1.0, *W[l]);
+        
+        double *bias = b[l]->data;
+        for (int k = 0; k < M; ++k) {
+            const double *d = delta[l][k];
+            for (int j = 0; j < layer_sizes[l+1]; ++j)
+                bias[j] += factor * d[j];
+        }
     }
-    
-    delete[] gradW;
-    delete[] gradb;
 }
 
 } // namespace ml
@@ -61,6 +61,23 @@ public:
                      int M,
                      double lr);
 
+    /**
+     * Batched forward propagation: one GEMM per layer, with bias and
+     * sigmoid fused into it
+     * @param X  M×in_dim Matrix, one sample per row
+     * @return   M×out_dim Matrix of outputs (after sigmoid)
+     */
+    Matrix forward_batch(const Matrix &X);
+
+    /**
+     * Mini-batch gradient descent with the whole batch propagated as a
+     * matrix, forward and backward
+     * @param X   M×in_dim inputs, one sample per row
+     * @param Y   M×out_dim targets, one sample per row
+     * @param lr  Learning rate
+     */
+    void train_batch(const Matrix &X, const Matrix &Y, double lr);
+
 private:
     /// Sigmoid activation
     static double sigmoid(double x) {
@@ -2,6 +2,7 @@
 #include <pybind11/numpy.h>
 #include "Neural_net.hpp" // defines ml::NeuralNetwork
 #include "Matrix.hpp" // defines global ::Vector
+#include <algorithm>
 
 namespace py = pybind11;
 
@@ -33,37 +34,48 @@ PYBIND11_MODULE(neural_net, m) {
             },
             py::arg("input"),
             "Run forward propagation on a single sample")
+        .def("forward_batch",
+            [](ml::NeuralNetwork &nn, py::array_t<double, py::array::c_style | py::array::forcecast> X) {
+                auto xb = X.unchecked<2>();
+                int M = static_cast<int>(xb.shape(0));
+                int in_dim = static_cast<int>(xb.shape(1));
+                if (M == 0) throw std::invalid_argument("forward_batch needs at least one sample");
+
+                ::Matrix inputs(M, in_dim);
+                for (int k = 0; k < M; ++k)
+                    std::copy(&xb(k, 0), &xb(k, 0) + in_dim, inputs[k]);
+
+                ::Matrix out = nn.forward_batch(inputs);
+                py::array_t<double> result({M, out.cols});
+                auto rbuf = result.mutable_unchecked<2>();
+                for (int k = 0; k < M; ++k)
+                    std::copy(out[k], out[k] + out.cols, &rbuf(k, 0));
+                return result;
+            },
+            py::arg("X"),
+            "Run forward propagation on a batch of samples, one per row")
         .def("train_batch",
             [](ml::NeuralNetwork &nn,
-               py::array_t<double> X,
-               py::array_t<double> Y,
+               py::array_t<double, py::array::c_style | py::array::forcecast> X,
+               py::array_t<double, py::array::c_style | py::array::forcecast> Y,
                int batch_size,
                double lr) {
                 auto xb = X.unchecked<2>();
                 auto yb = Y.unchecked<2>();
+                if (batch_size <= 0 || batch_size > xb.shape(0) || batch_size > yb.shape(0))
+                    throw std::invalid_argument("batch_size does not match X and Y");
                 
-                // Suppress alloc-size-larger-than warning: batch_size > 0 guaranteed
-                #pragma GCC diagnostic push
-                #pragma GCC diagnostic ignored "-Walloc-size-larger-than="
-                ::Vector *inputs = new ::Vector[static_cast<size_t>(batch_size)];
-                ::Vector *targets = new ::Vector[static_cast<size_t>(batch_size)];
-                #pragma GCC diagnostic pop
-                
+                // The batch goes in as two matrices, one sample per row
                 int in_dim = static_cast<int>(xb.shape(1));
                 int out_dim = static_cast<int>(yb.shape(1));
-                
+                ::Matrix inputs(batch_size, in_dim);
+                ::Matrix targets(batch_size, out_dim);
                 for (int k = 0; k < batch_size; ++k) {
-                    inputs[k] = ::Vector(in_dim);
-                    targets[k] = ::Vector(out_dim);
-                    for (int j = 0; j < in_dim; ++j)
-                        inputs[k](j) = xb(k, j);
-                    for (int j = 0; j < out_dim; ++j)
-                        targets[k](j) = yb(k, j);
+                    std::copy(&xb(k, 0), &xb(k, 0) + in_dim, inputs[k]);
+                    std::copy(&yb(k, 0), &yb(k, 0) + out_dim, targets[k]);
                 }
                 
-                nn.train_batch(inputs, targets, batch_size, lr);
-                delete[] inputs;
-                delete[] targets;
+                nn.train_batch(inputs, targets, lr);
             },
             py::arg("X"),
             py::arg("Y"),
@@ -115,7 +115,7 @@ def main():
             nn.train_batch(X_batch, Y_batch, batch_size=X_batch.shape[0], lr=lr)
 
         # compute validation accuracy
-        preds = np.vstack([nn.forward(x) for x in X_val])
+        preds = nn.forward_batch(X_val)
         acc = np.mean(np.argmax(preds,1) == np.argmax(Y_val,1))
         print(f"Epoch {epoch}/{epochs} — val accuracy: {acc:.4f}")
 
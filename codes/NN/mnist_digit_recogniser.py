@@ -61,7 +61,7 @@ def main():
             nn.train_batch(X_batch, Y_batch, batch_size=X_batch.shape[0], lr=lr)
 
         # compute validation accuracy
-        preds = np.vstack([nn.forward(x) for x in X_val])
+        preds = nn.forward_batch(X_val)
         pred_labels = np.argmax(preds, axis=1)
         true_labels = np.argmax(Y_val, axis=1)
         acc = np.mean(pred_labels == true_labels)
@@ -69,7 +69,7 @@ def main():
 
     # 5) Predict on test set
     print("Predicting on test set...")
-    test_preds = np.vstack([nn.forward(x) for x in X_test])
+    test_preds = nn.forward_batch(X_test)
     test_labels = np.argmax(test_preds, axis=1).astype(int)
 
     # 6) Write submission.csv
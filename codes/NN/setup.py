@@ -4,8 +4,9 @@ from pybind11.setup_helpers import Pybind11Extension, build_ext
 ext_modules = [
     Pybind11Extension(
         "neural_net",  # Python module name
-        ["Neural_net.cpp", "bindings.cpp"],  # your C++ sources
+        ["Neural_net.cpp", "Gemm.cpp", "bindings.cpp"],  # your C++ sources
         cxx_std=17,  # C++17 standard
+        extra_compile_args=["-O3"],  # AVX2/FMA kernels are chosen at run time
     ),
 ]
 
@@ -0,0 +1,52 @@
+#ifndef EVALUATOR_HPP
+#define EVALUATOR_HPP
+
+#include <string>
+#include "../position.hpp"
+#include "basiceval.hpp"
+#include "pestoeval.hpp"
+
+//----------------------------------------------------------------------
+// Evaluator policies
+//
+// The search is a template over one of these. Each policy only exposes
+// static functions, so every Evaluate call in negamax / Quiescence is a
+// direct call resolved at compile time (no virtual dispatch per node).
+//----------------------------------------------------------------------
+
+struct BasicEvaluator {
+    static constexpr const char* name = "basic";
+    static void init() {}
+    static int evaluate(const Position& pos) { return BasicEval::Evaluate(pos); }
+};
+
+struct PestoEvaluator {
+    static constexpr const char* name = "pesto";
+    static void init() { PestoEval::init_tables(); }
+    static int evaluate(const Position& pos) { return PestoEval::Evaluate(pos); }
+};
+
+// Runtime handle used to pick an instantiation once, at the root
+enum class EvaluatorType {
+    Basic,
+    Pesto
+};
+
+inline const char* evaluator_name(EvaluatorType type) {
+    return type == EvaluatorType::Pesto ? PestoEvaluator::name : BasicEvaluator::name;
+}
+
+// Returns false if `name` is not a known evaluator
+inline bool parse_evaluator(const std::string& name, EvaluatorType& type) {
+    if (name == BasicEvaluator::name) { type = EvaluatorType::Basic; return true; }
+    if (name == PestoEvaluator::name) { type = EvaluatorType::Pesto; return true; }
+    return false;
+}
+
+// Initialise the lookup tables of every evaluator
+inline void init_evaluators() {
+    BasicEvaluator::init();
+    PestoEvaluator::init();
+}
+
+#endif // EVALUATOR_HPP
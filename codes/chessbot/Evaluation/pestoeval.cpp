@@ -166,6 +166,8 @@ int eg_table[12][64];
 // Evaluate: material + positional, from side-to-move's perspective
 //----------------------------------------------------------------------
 
+namespace PestoEval {
+
 void init_tables() {
     int pc, p, sq;
     for (p = PAWN, pc = WHITE_PAWN; p <= KING; pc += 2, p++) {
@@ -187,14 +189,10 @@ int Evaluate(const Position& pos) {
     int eg[2] = {0, 0}; // endgame scores [WHITE, BLACK]
     int gamePhase = 0;
 
-    // Map your piece constants to the evaluation system
+    // Map your piece constants (Piece enum order: wP..wK, bP..bK) to the evaluation system
     const int piece_map[12] = {
-        WHITE_PAWN,   BLACK_PAWN,   // wP, bP
-        WHITE_KNIGHT, BLACK_KNIGHT, // wN, bN
-        WHITE_BISHOP, BLACK_BISHOP, // wB, bB
-        WHITE_ROOK,   BLACK_ROOK,   // wR, bR
-        WHITE_QUEEN,  BLACK_QUEEN,  // wQ, bQ
-        WHITE_KING,   BLACK_KING    // wK, bK
+        WHITE_PAWN, WHITE_KNIGHT, WHITE_BISHOP, WHITE_ROOK, WHITE_QUEEN, WHITE_KING, // wP..wK
+        BLACK_PAWN, BLACK_KNIGHT, BLACK_BISHOP, BLACK_ROOK, BLACK_QUEEN, BLACK_KING  // bP..bK
     };
 
     // Evaluate all pieces using bitboards
@@ -232,80 +230,4 @@ int Evaluate(const Position& pos) {
     return final_score;
 }
 
-// Rest of your search functions remain the same
-int negamax(Position pos, int depth, int alpha, int beta) {
-    if (depth <= 0) {
-        return Evaluate(pos);
-    }
-
-    pos.generate_moves();
-    //pos.order_moves();
-
-    if (pos.move_list.empty()) {
-        Color us = pos.SideToMove;
-        Color them = (us == White) ? Black : White;
-        
-        U64 king_bb = pos.bitboards[us == White ? wK : bK];
-        if (!king_bb) return -30000 + depth;
-        
-        int king_sq = get_ls1b_index(king_bb);
-        
-        return isSquareAttacked(king_sq, pos, them) 
-            ? -30000 + depth  // Checkmate
-            : 0;              // Stalemate
-    }
-
-    int best_score = -31000;
-    
-    for (const Move &move : pos.move_list) {
-        Position next_pos = makemove(move, pos);
-        int score = -negamax(next_pos, depth - 1, -beta, -alpha);
-        
-        best_score = std::max(best_score, score);
-        
-        if (score >= beta) {
-            return beta;  // Beta cutoff
-        }
-        
-        alpha = std::max(alpha, score);
-    }
-    
-    return best_score;
-}
-
-Move Search_Position(const Position &pos, int depth) {
-    Position root = pos;
-    root.generate_moves();
-    //root.order_moves();
-    
-    if (root.move_list.empty()) {
-        return 0;
-    }
-
-    Move best_move = root.move_list[0];
-    int best_score = -32000;
-
-    for (const Move &move : root.move_list) {
-        Position next_pos = makemove(move, root);
-        int score = -negamax(next_pos, depth - 1, -32000, 32000);
-        
-        if (score > best_score) {
-            best_score = score;
-            best_move = move;
-        }
-    }
-
-    std::cout << "Best eval: " << best_score << "\n";
-    return best_move;
-}
-
-Move findbestmove(Position position) {
-    auto start = std::chrono::high_resolution_clock::now();
-    Move best_move = Search_Position(position, 6);
-    auto end = std::chrono::high_resolution_clock::now();
-    
-    auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(end - start);
-    std::cout << "Search completed in " << duration.count() << " ms\n";
-    
-    return best_move;
-}
+} // namespace PestoEval
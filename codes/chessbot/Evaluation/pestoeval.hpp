@@ -11,7 +11,6 @@
 #include <climits>
 #include <vector>
 #include <algorithm>
-#include <chrono>
 
 // Piece type definitions for internal evaluation
 #define PAWN   0
@@ -72,11 +71,11 @@ extern int gamephaseInc[12];
 extern int mg_table[12][64];
 extern int eg_table[12][64];
 
-// Function declarations
-void init_tables();
-int Evaluate(const Position& pos);
-int negamax(Position pos, int depth, int alpha, int beta);
-Move Search_Position(const Position& pos, int depth);
-Move findbestmove(Position position);
+// Function declarations (the search lives in search.hpp and reaches
+// these through the PestoEvaluator policy in evaluator.hpp)
+namespace PestoEval {
+    void init_tables();
+    int Evaluate(const Position& pos);
+}
 
 #endif // PESTOEVAL_HPP
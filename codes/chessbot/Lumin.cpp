@@ -4,6 +4,7 @@
 #include <string>
 #include <ctime>
 #include <cstdlib>
+#include <algorithm>
 
 #include "bitboard.hpp"
 #include "position.hpp"
@@ -16,22 +17,156 @@
 #include "perftest.hpp"
 #include "uci.hpp"
 #include "game.hpp"
-#include "Evaluation/basiceval.hpp"
+#include "search.hpp"
+#include "tt.hpp"
+#include "bench.hpp"
+#include "analyze.hpp"
+#include "match.hpp"
+#include "mate.hpp"
+#include "book.hpp"
+#include "bitbase.hpp"
+#include "datagen.hpp"
+#include "tune.hpp"
+#include "server.hpp"
+#include "trace.hpp"
+#include "Evaluation/evaluator.hpp"
 
 // Initialize all attack tables
 void init_all() {
     init_sliders();      // Magic bitboards for sliding pieces
     init_nonsliders();   // Lookup tables for pawns, knights, kings
-    std::cout << "Attack tables initialized.\n";
+    init_evaluators();   // Evaluation lookup tables (PeSTO)
+    std::cerr << "Attack tables initialized.\n";   // keep stdout clean for machine-readable modes
 }
 
-int main() {
+void print_usage(const char* program) {
+    std::cout << "Usage: " << program << " [--eval basic|pesto] [--search alphabeta|mcts] [--tc seconds+increment] [--no-ponder] [--book file.bin] [--bitbases dir] [--hash-file file] [--trace file] [uci | bench [depth] [threads] | perft <depth> [fen] | perftsuite [epd] [max_nodes] | analyze --epd <file> ... | match --engine1 <spec> --engine2 <spec> ... | bitbase generate|probe <dir> ... | mate <fen> <max_moves> ... | datagen --out <file> ... | tune --data <file> ... | serve --socket <path>|--port N ... | trace <file>]\n";
+}
+
+int main(int argc, char* argv[]) {
     // Initialize random seed
     std::srand(static_cast<unsigned int>(std::time(nullptr)));
     
     // Initialize all attack tables, bitboards, magics, etc.
     init_all();
+
+    // Game clock in milliseconds (--tc 180+2)
+    int base_ms = 180000, inc_ms = 2000;
+    // Search on the human's time in Bot vs Human games
+    bool ponder = true;
+    // bench compares every evaluator unless --eval picks one
+    bool eval_chosen = false;
+    // Transposition table kept across sessions (--hash-file)
+    std::string hash_file;
+
+    // Command line: evaluator selection and non-interactive modes
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--eval" && i + 1 < argc) {
+            if (!parse_evaluator(argv[++i], active_evaluator)) {
+                std::cout << "Unknown evaluator: " << argv[i] << "\n";
+                print_usage(argv[0]);
+                return 1;
+            }
+            eval_chosen = true;
+        } else if (arg == "--search" && i + 1 < argc) {
+            if (!parse_search_algorithm(argv[++i], active_search)) {
+                std::cout << "Unknown search: " << argv[i] << "\n";
+                print_usage(argv[0]);
+                return 1;
+            }
+        } else if (arg == "--tc" && i + 1 < argc) {
+            std::string tc = argv[++i];
+            size_t plus = tc.find('+');
+            base_ms = static_cast<int>(std::atof(tc.substr(0, plus).c_str()) * 1000);
+            inc_ms = plus == std::string::npos ? 0 : static_cast<int>(std::atof(tc.substr(plus + 1).c_str()) * 1000);
+            if (base_ms <= 0) {
+                print_usage(argv[0]);
+                return 1;
+            }
+        } else if (arg == "--no-ponder") {
+            ponder = false;
+        } else if (arg == "--book" && i + 1 < argc) {
+            if (!book.open(argv[++i])) {
+                std::cout << "Cannot open book: " << argv[i] << "\n";
+                return 1;
+            }
+            std::cerr << "Book: " << argv[i] << " (" << book.size() << " entries)\n";
+        } else if (arg == "--bitbases" && i + 1 < argc) {
+            int loaded = Bitbase::load(argv[++i]);
+            if (loaded == 0) {
+                std::cout << "No bitbases in " << argv[i] << "\n";
+                return 1;
+            }
+            std::cerr << "Bitbases: " << loaded << " tables, up to " << Bitbase::max_pieces << " pieces\n";
+        } else if (arg == "--hash-file" && i + 1 < argc) {
+            // Warm start: load the table if the file is there, save it on leaving uci
+            hash_file = argv[++i];
+            if (tt.load(hash_file)) std::cerr << "Hash: " << hash_file << " (" << tt.size_mb() << " MB)\n";
+        } else if (arg == "--trace" && i + 1 < argc) {
+            // Per-node search events of everything that follows (make TRACE=1)
+#ifdef LUMIN_TRACE
+            if (!Trace::open(argv[++i])) {
+                std::cout << "Cannot open trace file: " << argv[i] << "\n";
+                return 1;
+            }
+            std::cerr << "Trace: " << argv[i] << "\n";
+#else
+            std::cout << "--trace needs a build with make TRACE=1\n";
+            return 1;
+#endif
+        } else if (arg == "uci") {
+            uci_loop();
+            if (!hash_file.empty() && !tt.save(hash_file)) {
+                std::cerr << "Cannot save hash to " << hash_file << "\n";
+                return 1;
+            }
+            return 0;
+        } else if (arg == "bench") {
+            int depth = (i + 1 < argc) ? std::atoi(argv[i + 1]) : BENCH_DEFAULT_DEPTH;
+            int threads = (i + 2 < argc) ? std::atoi(argv[i + 2]) : 1;
+            run_bench(depth > 0 ? depth : BENCH_DEFAULT_DEPTH, std::max(1, threads), !eval_chosen);
+            return 0;
+        } else if (arg == "perft" && i + 1 < argc) {
+            int depth = std::atoi(argv[++i]);
+            std::string fen;
+            while (++i < argc) fen += std::string(argv[i]) + " ";
+            Position position = fen.empty() ? Position() : parsefen(fen);
+
+            auto t0 = std::chrono::steady_clock::now();
+            uint64_t nodes = perft_count(depth, position);
+            double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count();
+            std::cout << "Perft(" << depth << ") = " << nodes << " in " << ms << " ms, "
+                      << static_cast<uint64_t>(ms > 0 ? nodes * 1000.0 / ms : 0) << " nps\n";
+            return 0;
+        } else if (arg == "perftsuite") {
+            std::string epd = (i + 1 < argc) ? argv[i + 1] : "perftsuite.epd";
+            uint64_t max_nodes = (i + 2 < argc) ? std::strtoull(argv[i + 2], nullptr, 10) : 200000000ULL;
+            return perft_suite(epd, max_nodes) == 0 ? 0 : 1;
+        } else if (arg == "analyze") {
+            return analyze_main(std::vector<std::string>(argv + i + 1, argv + argc));
+        } else if (arg == "match") {
+            return match_main(std::vector<std::string>(argv + i + 1, argv + argc));
+        } else if (arg == "mate") {
+            return mate_main(std::vector<std::string>(argv + i + 1, argv + argc));
+        } else if (arg == "bitbase") {
+            return bitbase_main(std::vector<std::string>(argv + i + 1, argv + argc));
+        } else if (arg == "datagen") {
+            return datagen_main(std::vector<std::string>(argv + i + 1, argv + argc));
+        } else if (arg == "tune") {
+            return tune_main(std::vector<std::string>(argv + i + 1, argv + argc));
+        } else if (arg == "serve") {
+            return serve_main(std::vector<std::string>(argv + i + 1, argv + argc));
+        } else if (arg == "trace") {
+            return trace_main(std::vector<std::string>(argv + i + 1, argv + argc));
+        } else {
+            print_usage(argv[0]);
+            return 1;
+        }
+    }
     
+    std::cout << "Evaluator: " << evaluator_name(active_evaluator) << "\n";
+    std::cout << "Search: " << search_algorithm_name(active_search) << "\n";
     std::cout << "Welcome to " << NAME << "!\n";
     std::cout << "Choose mode:\n";
     std::cout << "1. Bot vs Human\n";
@@ -39,9 +174,15 @@ int main() {
     std::cout << "3. Test Position\n";
     std::cout << "Enter your choice (1, 2, or 3): ";
 
-    int mode = 0;
-    std::cin >> mode;
+    // A GUI starting us without arguments sends "uci" first
+    std::string choice;
+    std::cin >> choice;
     std::cin.ignore(); // Clear newline
+    if (choice == "uci") {
+        uci_loop(choice);
+        return 0;
+    }
+    int mode = std::atoi(choice.c_str());
 
     if (mode == 1) {
         // Set up initial position
@@ -50,6 +191,8 @@ int main() {
 
         Game game;
         game.currposition = start;
+        game.setTimeControl(base_ms, inc_ms);
+        game.setPondering(ponder);
 
         std::cout << "Choose your side (w for White, b for Black): ";
         char side;
@@ -64,6 +207,7 @@ int main() {
 
         Game game;
         game.currposition = start;
+        game.setTimeControl(base_ms, inc_ms);
 
         std::cout << "Bot vs Bot mode selected. Press Enter to start.\n";
         std::cin.ignore();
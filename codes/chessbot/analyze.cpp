@@ -0,0 +1,210 @@
+#include <iostream>
+#include <iomanip>
+#include <fstream>
+#include <sstream>
+#include <chrono>
+#include <mutex>
+#include <thread>
+#include <atomic>
+#include <memory>
+#include <algorithm>
+
+#include "analyze.hpp"
+#include "epd.hpp"
+#include "position.hpp"
+#include "search.hpp"
+#include "tt.hpp"
+#include "uci.hpp"
+
+static std::string json_escape(std::string_view text) {
+    std::string out;
+    for (char c : text) {
+        if (c == '"' || c == '\\') out += '\\';
+        out += c;
+    }
+    return out;
+}
+
+// True when one of the SAN moves in `moves` (an EPD bm / am operand list) is `move`
+static bool move_in_list(std::string_view moves, Move move, const Position& position) {
+    for (std::string_view san = next_token(moves); !san.empty(); san = next_token(moves)) {
+        if (parse_san(std::string(san), position) == move) return true;
+    }
+    return false;
+}
+
+//----------------------------------------------------------------------
+// Work queue: workers take the lines of the memory-mapped file one at a
+// time, so nothing is read ahead or copied.
+//----------------------------------------------------------------------
+
+class EpdQueue {
+public:
+    explicit EpdQueue(EpdFile& file) : file(file) {}
+
+    bool next(std::string_view& line, size_t& line_number) {
+        std::lock_guard<std::mutex> lk(lock);
+        return file.next(line, line_number);
+    }
+
+private:
+    EpdFile& file;
+    std::mutex lock;
+};
+
+struct AnalyzeTotals {
+    std::atomic<uint64_t> positions{0};
+    std::atomic<uint64_t> nodes{0};
+    std::atomic<uint64_t> scored{0};     // positions with bm or am
+    std::atomic<uint64_t> solved{0};
+};
+
+static void analyze_worker(int id, int jobs, EpdQueue& queue, const SearchLimits& limits,
+                           TranspositionTable& shared_table, std::ostream& out, std::mutex& out_lock,
+                           AnalyzeTotals& totals) {
+    TranspositionTable table(shared_table, id, jobs);
+    TimeManager timer;
+    auto stats = std::make_unique<SearchStats::Group>();
+    set_search_context(SearchContext{&table, &timer, stats.get()});
+
+    Position position;
+    std::string_view text, operations;
+    size_t line_number = 0;
+    while (queue.next(text, line_number)) {
+        FenError error = parse_epd(text, position, operations);
+        if (error != FenError::None) {
+            std::lock_guard<std::mutex> lk(out_lock);
+            std::cerr << "Skipping line " << line_number << ": " << fen_error_string(error) << "\n";
+            continue;
+        }
+        position.generate_moves();
+
+        std::string_view id, best_moves, avoid_moves;
+        epd_operation(operations, "id", id);
+        bool has_bm = epd_operation(operations, "bm", best_moves);
+        bool has_am = epd_operation(operations, "am", avoid_moves);
+
+        // Results must not depend on which worker got the position before
+        table.clear();
+        std::vector<PVLine> lines;
+        Move best = findbestmove(position, limits, SearchOutput::Silent, &lines);
+
+        SearchStats::Totals searched = SearchStats::collect();
+        int depth = searched.depths.empty() ? 0 : searched.depths.back().depth;
+        int score = lines.empty() ? 0 : lines.front().score;
+        std::string best_san = best ? move_to_san(best, position) : "";
+
+        // Solved: one of the bm moves and none of the am moves
+        bool scored = has_bm || has_am;
+        bool solved = scored && best
+                   && (!has_bm || move_in_list(best_moves, best, position))
+                   && (!has_am || !move_in_list(avoid_moves, best, position));
+
+        std::ostringstream line;
+        line << "{\"line\": " << line_number
+             << ", \"id\": \"" << json_escape(unquote(id)) << "\""
+             << ", \"fen\": \"" << position.get_fen() << "\""
+             << ", \"bestmove\": \"" << move_to_uci(best) << "\""
+             << ", \"san\": \"" << best_san << "\""
+             << ", \"score\": \"" << uci_score(score, depth) << "\""
+             << ", \"depth\": " << depth
+             << ", \"nodes\": " << searched.nodes
+             << ", \"time_ms\": " << std::fixed << std::setprecision(1) << searched.time_ms
+             << ", \"pv\": [";
+        if (!lines.empty()) {
+            for (size_t i = 0; i < lines.front().pv.size(); ++i)
+                line << (i ? ", " : "") << "\"" << move_to_uci(lines.front().pv[i]) << "\"";
+        }
+        line << "]";
+        if (scored) line << ", \"solved\": " << (solved ? "true" : "false");
+        line << "}\n";
+
+        {
+            std::lock_guard<std::mutex> lk(out_lock);
+            out << line.str() << std::flush;
+        }
+
+        totals.positions += 1;
+        totals.nodes += searched.nodes;
+        totals.scored += scored;
+        totals.solved += solved;
+    }
+}
+
+static void print_analyze_usage() {
+    std::cerr << "Usage: lumin analyze --epd <file> (--depth D | --nodes N | --movetime MS)"
+                 " [--jobs J] [--hash MB] [--out <file>]\n";
+}
+
+int analyze_main(const std::vector<std::string>& args) {
+    std::string epd_path, out_path;
+    SearchLimits limits;
+    int jobs = std::max(1u, std::thread::hardware_concurrency());
+    int hash_mb = 64;
+
+    for (size_t i = 0; i < args.size(); ++i) {
+        const std::string& arg = args[i];
+        bool has_value = i + 1 < args.size();
+        if      (arg == "--epd" && has_value)      epd_path = args[++i];
+        else if (arg == "--out" && has_value)      out_path = args[++i];
+        else if (arg == "--depth" && has_value)    limits.depth = std::atoi(args[++i].c_str());
+        else if (arg == "--nodes" && has_value)    limits.nodes = std::strtoull(args[++i].c_str(), nullptr, 10);
+        else if (arg == "--movetime" && has_value) limits.movetime = std::atoi(args[++i].c_str());
+        else if (arg == "--jobs" && has_value)     jobs = std::atoi(args[++i].c_str());
+        else if (arg == "--hash" && has_value)     hash_mb = std::atoi(args[++i].c_str());
+        else {
+            print_analyze_usage();
+            return 1;
+        }
+    }
+
+    if (epd_path.empty() || (limits.depth <= 0 && limits.nodes == 0 && limits.movetime <= 0)) {
+        print_analyze_usage();
+        return 1;
+    }
+    jobs = std::clamp(jobs, 1, SearchStats::MAX_THREADS);
+
+    EpdFile file(epd_path);
+    if (!file.is_open()) {
+        std::cerr << "Cannot read " << epd_path << "\n";
+        return 1;
+    }
+
+    std::ofstream file_out;
+    if (!out_path.empty()) {
+        file_out.open(out_path);
+        if (!file_out) {
+            std::cerr << "Cannot write " << out_path << "\n";
+            return 1;
+        }
+    }
+    std::ostream& out = out_path.empty() ? std::cout : file_out;
+
+    // Each worker runs plain single-threaded, single-PV searches
+    search_threads = 1;
+    multi_pv = 1;
+
+    TranspositionTable shared_table(std::max(1, hash_mb));
+    std::mutex out_lock;
+    AnalyzeTotals totals;
+    EpdQueue queue(file);
+
+    auto t0 = std::chrono::steady_clock::now();
+    std::vector<std::thread> workers;
+    for (int id = 0; id < jobs; ++id) {
+        workers.emplace_back(analyze_worker, id, jobs, std::ref(queue), std::cref(limits),
+                             std::ref(shared_table), std::ref(out), std::ref(out_lock), std::ref(totals));
+    }
+    for (std::thread& worker : workers) worker.join();
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+
+    std::cerr << "Analyzed " << totals.positions << " positions with " << jobs << " job(s) in "
+              << std::fixed << std::setprecision(1) << seconds << " s, "
+              << totals.nodes << " nodes, "
+              << static_cast<uint64_t>(seconds > 0 ? totals.nodes / seconds : 0) << " nps\n";
+    if (totals.scored > 0) {
+        std::cerr << "Solved " << totals.solved << "/" << totals.scored << " ("
+                  << std::setprecision(1) << 100.0 * totals.solved / totals.scored << "%)\n";
+    }
+    return 0;
+}
@@ -0,0 +1,18 @@
+#ifndef ANALYZE_HPP
+#define ANALYZE_HPP
+
+#include <string>
+#include <vector>
+
+// lumin analyze --epd <file> (--depth D | --nodes N | --movetime MS)
+//               [--jobs J] [--hash MB] [--out <file>]
+//
+// Streams the positions of an EPD file to J workers, each running an
+// independent single-threaded search with its own slice of one shared
+// transposition table. One JSON line per position is written as soon as
+// it is done (completion order, with its line number in the file). Positions
+// with bm / am operations are scored, and the solve rate is reported at
+// the end. Returns the process exit code.
+int analyze_main(const std::vector<std::string>& args);
+
+#endif // ANALYZE_HPP
@@ -0,0 +1,122 @@
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <string>
+#include <vector>
+
+#include "bench.hpp"
+#include "position.hpp"
+#include "search.hpp"
+#include "tt.hpp"
+#include "uci.hpp"
+#include "Evaluation/evaluator.hpp"
+
+// Openings, middlegames with tactics, and endgames from trivial to tricky
+// (the last one is a mate in two). Changing this list changes the
+// signature, so only append to it together with a note in the commit.
+static const std::vector<std::string> bench_fens = {
+    "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1",
+    "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 10",
+    "8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 11",
+    "4rrk1/pp1n3p/3q2pQ/2p1pb2/2PP4/2P3N1/P2B2PP/4RRK1 b - - 7 19",
+    "rq3rk1/ppp2ppp/1bnpb3/3N2B1/3NP3/7P/PPPQ1PP1/2KR3R w - - 7 14",
+    "r1bq1r1k/1pp1n1pp/1p1p4/4p2Q/4Pp2/1BNP4/PPP2PPP/3R1RK1 w - - 2 14",
+    "r3r1k1/2p2ppp/p1p1bn2/8/1q2P3/2NPQN2/PPP3PP/R4RK1 b - - 2 15",
+    "r1bbk1nr/pp3p1p/2n5/1N4p1/2Np1B2/8/PPP2PPP/2KR1B1R w kq - 0 13",
+    "r1bq1rk1/ppp1nppp/4n3/3p3Q/3P4/1BP1B3/PP1N2PP/R4RK1 w - - 1 16",
+    "4r1k1/r1q2ppp/ppp2n2/4P3/5Rb1/1N1BQ3/PPP3PP/R5K1 w - - 1 17",
+    "2rqkb1r/ppp2p2/2npb1p1/1N1Nn2p/2P1PP2/8/PP2B1PP/R1BQK2R b KQ - 0 11",
+    "r1bq1r1k/b1p1npp1/p2p3p/1p6/3PP3/1B2NN2/PP3PPP/R2Q1RK1 w - - 1 16",
+    "3r1rk1/p5pp/bpp1pp2/8/q1PP1P2/b3P3/P2NQRPP/1R2B1K1 b - - 6 22",
+    "r1q2rk1/2p1bppp/2Pp4/p6b/Q1PNp3/4B3/PP1R1PPP/2K4R w - - 2 18",
+    "4k2r/1pb2ppp/1p2p3/1R1p4/3P4/2r1PN2/P4PPP/1R4K1 b - - 3 22",
+    "3q2k1/pb3p1p/4pbp1/2r5/PpN2N2/1P2P2P/5PP1/Q2R2K1 b - - 4 26",
+    "6k1/6p1/6Pp/ppp5/3pn2P/1P3K2/1PP2P2/8 b - - 0 1",
+    "8/8/8/8/5kp1/P7/8/1K1N4 w - - 0 1",
+    "8/8/8/5N2/8/p7/8/2NK3k w - - 0 1",
+    "8/3k4/8/8/8/4B3/4KB2/2B5 w - - 0 1",
+    "8/8/1P6/5pr1/8/4R3/7k/2K5 w - - 0 1",
+    "8/2p4P/8/kr6/6R1/8/8/1K6 w - - 0 1",
+    "8/8/3P3k/8/1p6/8/1P6/1K3n2 b - - 0 1",
+    "8/R7/2q5/8/6k1/8/1P5p/K6R w - - 0 124",
+    "6k1/3b3r/1p1p4/p1n2p2/1PPNpP1q/P3Q1p1/1R1RB1P1/5K2 b - - 0 1",
+    "r2r1n2/pp2bk2/2p1p2p/3q4/3PN1QP/2P3R1/P4PP1/5RK1 w - - 0 1",
+    "8/8/8/8/8/6k1/6p1/6K1 b - - 0 1",
+    "7k/7P/6K1/8/3B4/8/8/8 w - - 0 1",
+    "rnbqkb1r/ppp1pppp/5n2/8/2pP4/5N2/PP2PPPP/RNBQKB1R w KQkq - 2 4",
+    "r1bqkb1r/pp2pppp/2np1n2/8/3NP3/2N5/PPP2PPP/R1BQKB1R w KQkq - 2 6",
+    "rnbqkb1r/ppp2ppp/4pn2/3p2B1/3PP3/2N5/PPP2PPP/R2QKBNR b KQkq - 3 4",
+    "r1bqkbnr/1ppp1ppp/p1n5/1B2p3/4P3/5N2/PPPP1PPP/RNBQK2R w KQkq - 0 4",
+    "rnbq1rk1/ppp1ppbp/3p1np1/8/2PPP3/2N2N2/PP3PPP/R1BQKB1R w KQ - 2 6",
+    "rnbqkb1r/pp1p1ppp/4pn2/2p5/2PP4/2N5/PP2PPPP/R1BQKBNR w KQkq - 0 4",
+    "r1bqkb1r/pppp1ppp/2n2n2/4p3/2B1P3/5N2/PPPP1PPP/RNBQK2R w KQkq - 4 4",
+    "8/8/8/3k4/8/8/3KP3/8 w - - 0 1",
+    "1K1k4/1P6/8/8/8/8/r7/2R5 w - - 0 1",
+    "6k1/5ppp/8/8/8/8/5PPP/3R2K1 w - - 0 1",
+    "8/8/4k3/3p4/3P4/4K3/8/8 w - - 0 1",
+    "r1b1kb1r/pppp1ppp/5q2/4n3/3KP3/2N3PN/PPP4P/R1BQ1B1R b kq - 0 1",
+};
+
+const std::vector<std::string>& bench_positions() {
+    return bench_fens;
+}
+
+template<typename Evaluator>
+static void bench_evaluator(int depth) {
+    uint64_t total_nodes = 0;
+    double total_ms = 0.0;
+    SearchStats::Totals stats;
+
+    std::cout << "\n=== Bench: " << Evaluator::name << " evaluator, depth " << depth
+              << ", " << search_threads << " thread(s) ===\n";
+
+    for (size_t i = 0; i < bench_fens.size(); ++i) {
+        const std::string& fen = bench_fens[i];
+        Position position = parsefen(fen);
+
+        SearchLimits limits;
+        limits.depth = depth;
+        tt.clear();   // every position starts cold, whatever ran before
+
+        auto t0 = std::chrono::steady_clock::now();
+        Move best = Search_Position<Evaluator>(position, limits, SearchOutput::Silent);
+        auto t1 = std::chrono::steady_clock::now();
+
+        uint64_t nodes = SearchStats::get_positions_searched();
+        if (SearchStats::enabled) stats += SearchStats::collect();
+        double ms = std::chrono::duration_cast<std::chrono::microseconds>(t1 - t0).count() / 1000.0;
+        total_nodes += nodes;
+        total_ms += ms;
+
+        std::cout << std::setw(2) << i + 1 << "/" << bench_fens.size() << "  "
+                  << std::setw(10) << nodes << " nodes  "
+                  << std::fixed << std::setprecision(1) << std::setw(9) << ms << " ms  best "
+                  << std::setw(5) << std::left << move_to_uci(best) << std::right
+                  << "  " << fen << "\n";
+    }
+
+    double nps = total_ms > 0 ? total_nodes * 1000.0 / total_ms : 0.0;
+    std::cout << "===========================\n"
+              << "Total time (ms) : " << std::fixed << std::setprecision(0) << total_ms << "\n"
+              << "Nodes searched  : " << total_nodes << "\n"
+              << "Nodes/second    : " << std::setprecision(0) << nps << std::endl;
+    if (SearchStats::enabled) std::cout << "Stats           : " << SearchStats::to_json(stats) << std::endl;
+}
+
+void run_bench(int depth, int threads, bool all_evaluators) {
+    int saved_threads = search_threads;
+    search_threads = threads;
+
+    if (all_evaluators) {
+        bench_evaluator<BasicEvaluator>(depth);
+        bench_evaluator<PestoEvaluator>(depth);
+    } else {
+        switch (active_evaluator) {
+            case EvaluatorType::Pesto: bench_evaluator<PestoEvaluator>(depth); break;
+            case EvaluatorType::Basic:
+            default:                   bench_evaluator<BasicEvaluator>(depth); break;
+        }
+    }
+
+    search_threads = saved_threads;
+}
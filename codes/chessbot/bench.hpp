@@ -0,0 +1,21 @@
+#ifndef BENCH_HPP
+#define BENCH_HPP
+
+#include <string>
+#include <vector>
+
+// Default search depth of "lumin bench"
+constexpr int BENCH_DEFAULT_DEPTH = 3;
+
+// Fixed-depth search over a fixed position set with a cleared TT per
+// position. The total node count is a signature of the search: it only
+// changes when search behaviour does (with a single thread; Lazy SMP
+// helpers make it timing dependent). NPS tracks speed. Runs the active
+// evaluator, or with `all_evaluators` every evaluator in turn, one
+// signature each.
+void run_bench(int depth, int threads = 1, bool all_evaluators = false);
+
+// The bench position set, also the corpus of the microbenchmarks
+const std::vector<std::string>& bench_positions();
+
+#endif // BENCH_HPP
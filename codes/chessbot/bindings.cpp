@@ -0,0 +1,318 @@
+#include <pybind11/pybind11.h>
+#include <pybind11/numpy.h>
+#include <pybind11/stl.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "position.hpp"
+#include "magic.hpp"
+#include "nonmagic.hpp"
+#include "movedef.hpp"
+#include "perftest.hpp"
+#include "search.hpp"
+#include "stats.hpp"
+#include "timeman.hpp"
+#include "tt.hpp"
+#include "uci.hpp"
+#include "Evaluation/evaluator.hpp"
+
+namespace py = pybind11;
+
+//----------------------------------------------------------------------
+// Python bindings
+//
+// Single-position calls mirror the command line modes. The *_batch calls
+// take a list of FENs: every FEN is parsed first (a bad one raises with
+// its index), then the GIL is released and the positions are shared out
+// over `threads` workers, each taking the next index from an atomic
+// counter. Results are written straight into NumPy arrays allocated
+// before the GIL was given up.
+//----------------------------------------------------------------------
+
+static const char* START_FEN = "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1";
+
+static Position position_from_fen(const std::string& fen) {
+    Position position;
+    FenError error = parse_fen(fen, position);
+    if (error != FenError::None)
+        throw py::value_error("invalid FEN (" + std::string(fen_error_string(error)) + "): " + fen);
+    position.generate_moves();
+    return position;
+}
+
+static std::vector<Position> positions_from_fens(const std::vector<std::string>& fens) {
+    std::vector<Position> positions(fens.size());
+    for (size_t i = 0; i < fens.size(); ++i) {
+        FenError error = parse_fen(fens[i], positions[i]);
+        if (error != FenError::None)
+            throw py::value_error("invalid FEN at index " + std::to_string(i) + " ("
+                                  + fen_error_string(error) + "): " + fens[i]);
+        positions[i].generate_moves();
+    }
+    return positions;
+}
+
+static EvaluatorType evaluator_from_name(const std::string& name) {
+    EvaluatorType type;
+    if (!parse_evaluator(name, type)) throw py::value_error("unknown evaluator: " + name);
+    return type;
+}
+
+static int worker_count(int threads, size_t jobs) {
+    if (threads <= 0) threads = static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+    threads = std::min(threads, SearchStats::MAX_THREADS);
+    return std::max(1, static_cast<int>(std::min<size_t>(threads, jobs)));
+}
+
+// Runs body(worker, index) for every index in [0, count) on `workers`
+// threads. The caller must have released the GIL.
+template<typename Body>
+static void parallel_for(size_t count, int workers, Body body) {
+    std::atomic<size_t> next{0};
+    auto run = [&](int worker) {
+        for (size_t i = next++; i < count; i = next++) body(worker, i);
+    };
+    std::vector<std::thread> pool;
+    for (int id = 1; id < workers; ++id) pool.emplace_back(run, id);
+    run(0);
+    for (std::thread& thread : pool) thread.join();
+}
+
+// Plain bulk-counting perft for the batch call: perft_count shares one
+// hash table and thread pool, so it cannot run in several threads at once
+static uint64_t perft_local(const Position& position, int depth) {
+    if (depth <= 1) return position.move_list.size();
+    uint64_t nodes = 0;
+    for (Move move : position.move_list) {
+        Position next = makemove(move, position);
+        next.generate_moves();
+        nodes += perft_local(next, depth - 1);
+    }
+    return nodes;
+}
+
+static int evaluate_position(EvaluatorType type, const Position& position) {
+    return type == EvaluatorType::Pesto ? PestoEvaluator::evaluate(position)
+                                        : BasicEvaluator::evaluate(position);
+}
+
+static SearchLimits make_limits(int depth, uint64_t nodes, int movetime) {
+    if (depth <= 0 && nodes == 0 && movetime <= 0)
+        throw py::value_error("search needs a depth, nodes or movetime limit");
+    SearchLimits limits;
+    limits.depth = depth;
+    limits.nodes = nodes;
+    limits.movetime = movetime;
+    return limits;
+}
+
+struct SearchOutcome {
+    Move move = 0;
+    int score = 0;
+    int depth = 0;
+    uint64_t nodes = 0;
+};
+
+// One single-threaded search with the calling thread's context, as an
+// analyze worker runs it
+static SearchOutcome search_once(EvaluatorType type, const Position& position, const SearchLimits& limits,
+                                 TranspositionTable& table) {
+    table.clear();
+    std::vector<PVLine> lines;
+    SearchOutcome outcome;
+    outcome.move = findbestmove(type, position, limits, SearchOutput::Silent, &lines);
+
+    SearchStats::Totals searched = SearchStats::collect();
+    outcome.depth = searched.depths.empty() ? 0 : searched.depths.back().depth;
+    outcome.score = lines.empty() ? 0 : lines.front().score;
+    outcome.nodes = searched.nodes;
+    return outcome;
+}
+
+//----------------------------------------------------------------------
+// Module
+//----------------------------------------------------------------------
+
+PYBIND11_MODULE(lumin, m) {
+    m.doc() = "Lumin chess engine: move generation, evaluation and search";
+
+    init_sliders();
+    init_nonsliders();
+    init_evaluators();
+    // Every search is plain single-threaded, single-PV; batches run them side by side
+    search_threads = 1;
+    multi_pv = 1;
+
+    m.attr("START_FEN") = START_FEN;
+
+    py::class_<Position>(m, "Position")
+        .def(py::init([](const std::string& fen) { return position_from_fen(fen); }),
+            py::arg("fen") = START_FEN,
+            "Position from a FEN string (the start position by default)")
+        .def("fen", &Position::get_fen, "FEN string of the position")
+        .def_property_readonly("side_to_move",
+            [](const Position& position) { return position.SideToMove == White ? "w" : "b"; })
+        .def("legal_moves",
+            [](const Position& position) {
+                std::vector<std::string> moves;
+                moves.reserve(position.move_list.size());
+                for (Move move : position.move_list) moves.push_back(move_to_uci(move));
+                return moves;
+            },
+            "Legal moves in UCI notation")
+        .def("make_move",
+            [](Position& position, const std::string& uci) {
+                Move move = parse_move(uci, position);
+                if (!move) throw py::value_error("illegal move: " + uci);
+                position = makemove(move, position);
+                position.generate_moves();
+            },
+            py::arg("move"),
+            "Play a move given in UCI notation")
+        .def("__repr__",
+            [](const Position& position) { return "Position('" + position.get_fen() + "')"; });
+
+    m.def("perft",
+        [](const std::string& fen, int depth) {
+            Position position = position_from_fen(fen);
+            py::gil_scoped_release release;
+            // perft_count drives the process-wide PerftPool, which runs one
+            // job at a time: without the GIL, Python threads queue here
+            static std::mutex pool_lock;
+            std::lock_guard<std::mutex> lock(pool_lock);
+            return perft_count(depth, position);
+        },
+        py::arg("fen"), py::arg("depth"),
+        "Leaf count of the legal move tree to `depth`");
+
+    m.def("evaluate",
+        [](const std::string& fen, const std::string& evaluator) {
+            return evaluate_position(evaluator_from_name(evaluator), position_from_fen(fen));
+        },
+        py::arg("fen"), py::arg("evaluator") = "pesto",
+        "Static evaluation in centipawns, side to move's point of view");
+
+    m.def("search",
+        [](const std::string& fen, int depth, uint64_t nodes, int movetime,
+           const std::string& evaluator, int hash_mb) {
+            Position position = position_from_fen(fen);
+            EvaluatorType type = evaluator_from_name(evaluator);
+            SearchLimits limits = make_limits(depth, nodes, movetime);
+
+            SearchOutcome outcome;
+            {
+                py::gil_scoped_release release;
+                TranspositionTable table(static_cast<size_t>(std::max(1, hash_mb)));
+                TimeManager timer;
+                auto stats = std::make_unique<SearchStats::Group>();
+                set_search_context(SearchContext{&table, &timer, stats.get()});
+                outcome = search_once(type, position, limits, table);
+                set_search_context(SearchContext{});
+            }
+            py::dict result;
+            result["move"] = outcome.move ? move_to_uci(outcome.move) : std::string();
+            result["score"] = outcome.score;
+            result["depth"] = outcome.depth;
+            result["nodes"] = outcome.nodes;
+            return result;
+        },
+        py::arg("fen"), py::arg("depth") = 0, py::arg("nodes") = 0, py::arg("movetime") = 0,
+        py::arg("evaluator") = "pesto", py::arg("hash_mb") = static_cast<int>(TranspositionTable::DEFAULT_MB),
+        "Search one position; returns a dict with move, score, depth and nodes");
+
+    m.def("perft_batch",
+        [](const std::vector<std::string>& fens, int depth, int threads) {
+            std::vector<Position> positions = positions_from_fens(fens);
+            py::array_t<uint64_t> result(static_cast<py::ssize_t>(positions.size()));
+            uint64_t* out = result.mutable_data();
+            {
+                py::gil_scoped_release release;
+                parallel_for(positions.size(), worker_count(threads, positions.size()),
+                    [&](int, size_t i) { out[i] = depth > 0 ? perft_local(positions[i], depth) : 1; });
+            }
+            return result;
+        },
+        py::arg("fens"), py::arg("depth"), py::arg("threads") = 0,
+        "perft of every FEN, as a uint64 array");
+
+    m.def("evaluate_batch",
+        [](const std::vector<std::string>& fens, const std::string& evaluator, int threads) {
+            std::vector<Position> positions = positions_from_fens(fens);
+            EvaluatorType type = evaluator_from_name(evaluator);
+            py::array_t<int32_t> result(static_cast<py::ssize_t>(positions.size()));
+            int32_t* out = result.mutable_data();
+            {
+                py::gil_scoped_release release;
+                parallel_for(positions.size(), worker_count(threads, positions.size()),
+                    [&](int, size_t i) { out[i] = evaluate_position(type, positions[i]); });
+            }
+            return result;
+        },
+        py::arg("fens"), py::arg("evaluator") = "pesto", py::arg("threads") = 0,
+        "Static evaluation of every FEN, as an int32 array");
+
+    m.def("search_batch",
+        [](const std::vector<std::string>& fens, int depth, uint64_t nodes, int movetime,
+           const std::string& evaluator, int threads, int hash_mb) {
+            std::vector<Position> positions = positions_from_fens(fens);
+            EvaluatorType type = evaluator_from_name(evaluator);
+            SearchLimits limits = make_limits(depth, nodes, movetime);
+            const size_t count = positions.size();
+
+            // UCI moves are at most 5 characters ("e7e8q"), NUL padded
+            py::array moves(py::dtype("S5"), {static_cast<py::ssize_t>(count)});
+            py::array_t<int32_t> scores(static_cast<py::ssize_t>(count));
+            py::array_t<int32_t> depths(static_cast<py::ssize_t>(count));
+            py::array_t<uint64_t> node_counts(static_cast<py::ssize_t>(count));
+            char* move_out = static_cast<char*>(moves.mutable_data());
+            int32_t* score_out = scores.mutable_data();
+            int32_t* depth_out = depths.mutable_data();
+            uint64_t* nodes_out = node_counts.mutable_data();
+            {
+                py::gil_scoped_release release;
+                const int workers = worker_count(threads, count);
+                TranspositionTable shared_table(static_cast<size_t>(std::max(1, hash_mb)));
+
+                // Each worker owns a slice of the table, a clock and a stats group
+                std::vector<std::thread> pool;
+                std::atomic<size_t> next{0};
+                for (int id = 0; id < workers; ++id) {
+                    pool.emplace_back([&, id]() {
+                        TranspositionTable table(shared_table, id, workers);
+                        TimeManager timer;
+                        auto stats = std::make_unique<SearchStats::Group>();
+                        set_search_context(SearchContext{&table, &timer, stats.get()});
+                        for (size_t i = next++; i < count; i = next++) {
+                            SearchOutcome outcome = search_once(type, positions[i], limits, table);
+                            std::string uci = outcome.move ? move_to_uci(outcome.move) : std::string();
+                            std::memset(move_out + i * 5, 0, 5);
+                            std::memcpy(move_out + i * 5, uci.data(), std::min<size_t>(uci.size(), 5));
+                            score_out[i] = outcome.score;
+                            depth_out[i] = outcome.depth;
+                            nodes_out[i] = outcome.nodes;
+                        }
+                    });
+                }
+                for (std::thread& thread : pool) thread.join();
+            }
+
+            py::dict result;
+            result["move"] = moves;
+            result["score"] = scores;
+            result["depth"] = depths;
+            result["nodes"] = node_counts;
+            return result;
+        },
+        py::arg("fens"), py::arg("depth") = 0, py::arg("nodes") = 0, py::arg("movetime") = 0,
+        py::arg("evaluator") = "pesto", py::arg("threads") = 0,
+        py::arg("hash_mb") = static_cast<int>(TranspositionTable::DEFAULT_MB),
+        "Search every FEN; returns a dict of arrays: move (S5), score, depth (int32), nodes (uint64)");
+}
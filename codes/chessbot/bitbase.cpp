@@ -0,0 +1,823 @@
+#include "bitbase.hpp"
+#include "attacks.hpp"
+#include "bitboard.hpp"
+
+#include <dirent.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <set>
+#include <thread>
+#include <unordered_map>
+
+namespace Bitbase {
+
+int max_pieces = 0;
+
+namespace {
+
+//----------------------------------------------------------------------
+// Squares and symmetries
+//
+// Pawnless tables use all 8 board symmetries to bring the white king into
+// the a1-d1-d4 triangle (10 squares); tables with pawns only mirror files,
+// leaving the white king on files a-d (32 squares). When the white king
+// sits on the a1-h8 diagonal two transforms qualify and the smaller index
+// wins, so every position has exactly one index.
+//----------------------------------------------------------------------
+
+inline int file_of(int sq) { return sq & 7; }
+inline int row_of(int sq)  { return sq >> 3; }     // row 0 = rank 8
+
+// bit 0: mirror files, bit 1: mirror ranks, bit 2: flip along a1-h8
+inline int transform(int sq, int symmetry) {
+    if (symmetry & 1) sq ^= 7;
+    if (symmetry & 2) sq ^= 56;
+    if (symmetry & 4) sq = (7 - file_of(sq)) * 8 + (7 - row_of(sq));
+    return sq;
+}
+
+struct KingRegions {
+    int8_t  pawnless[64];
+    int8_t  pawns[64];
+    uint8_t pawnless_square[10];
+    uint8_t pawns_square[32];
+
+    KingRegions() {
+        int n = 0, m = 0;
+        for (int sq = 0; sq < 64; ++sq) {
+            int file = file_of(sq), rank = 7 - row_of(sq);
+            pawnless[sq] = -1;
+            pawns[sq] = -1;
+            if (file <= 3 && rank <= file) {
+                pawnless_square[n] = static_cast<uint8_t>(sq);
+                pawnless[sq] = static_cast<int8_t>(n++);
+            }
+            if (file <= 3) {
+                pawns_square[m] = static_cast<uint8_t>(sq);
+                pawns[sq] = static_cast<int8_t>(m++);
+            }
+        }
+    }
+};
+
+const KingRegions regions;
+
+inline Color color_of(int piece) { return piece < bP ? White : Black; }
+inline int   swap_color(int piece) { return piece < bP ? piece + bP : piece - bP; }
+
+U64 attacks_from(int piece, int sq, U64 occupancy) {
+    switch (piece % bP) {
+        case wP: return pawn_attacks(color_of(piece), sq);
+        case wN: return knight_attacks(sq);
+        case wB: return bishop_attacks(sq, occupancy);
+        case wR: return rook_attacks(sq, occupancy);
+        case wQ: return queen_attacks(sq, occupancy);
+        default: return king_attacks(sq);
+    }
+}
+
+// A handful of pieces on the board, in no particular order
+struct Config {
+    int n = 0;
+    uint8_t piece[MAX_PIECES];
+    uint8_t square[MAX_PIECES];
+    int stm = White;
+};
+
+U64 occupancy_of(const uint8_t* square, int n) {
+    U64 occupancy = 0ULL;
+    for (int i = 0; i < n; ++i) occupancy |= 1ULL << square[i];
+    return occupancy;
+}
+
+bool attacked(int target, int by, const uint8_t* piece, const uint8_t* square, int n) {
+    U64 occupancy = occupancy_of(square, n);
+    for (int i = 0; i < n; ++i) {
+        if (color_of(piece[i]) == by && ((attacks_from(piece[i], square[i], occupancy) >> target) & 1))
+            return true;
+    }
+    return false;
+}
+
+//----------------------------------------------------------------------
+// Names and material
+//
+// "KRvKP": the letters after each K list the other men in Q R B N P order,
+// the stronger side first (more men, then the higher pieces).
+//----------------------------------------------------------------------
+
+constexpr char LETTERS[] = "PNBRQ";     // indexed by wP..wQ
+
+int letter_type(char c) {
+    const char* found = std::strchr(LETTERS, c);
+    return (c && found) ? static_cast<int>(found - LETTERS) : -1;
+}
+
+void sort_men(std::string& men) {
+    std::sort(men.begin(), men.end(), [](char a, char b) { return letter_type(a) > letter_type(b); });
+}
+
+bool stronger(const std::string& a, const std::string& b) {
+    if (a.size() != b.size()) return a.size() > b.size();
+    for (size_t i = 0; i < a.size(); ++i) {
+        if (a[i] != b[i]) return letter_type(a[i]) > letter_type(b[i]);
+    }
+    return false;
+}
+
+std::string make_name(std::string white, std::string black) {
+    sort_men(white);
+    sort_men(black);
+    if (stronger(black, white)) std::swap(white, black);
+    return "K" + white + "vK" + black;
+}
+
+// Splits and validates a name; accepts any letter order and side order
+bool parse_name(const std::string& name, std::string& white, std::string& black) {
+    size_t v = name.find('v');
+    if (name.size() < 4 || name[0] != 'K' || v == std::string::npos
+        || v + 1 >= name.size() || name[v + 1] != 'K') return false;
+    white = name.substr(1, v - 1);
+    black = name.substr(v + 2);
+    for (const std::string* men : {&white, &black}) {
+        for (char c : *men) if (letter_type(c) < 0) return false;
+    }
+    if (2 + white.size() + black.size() > static_cast<size_t>(MAX_PIECES)) return false;
+    std::string canonical = make_name(white, black);
+    white = canonical.substr(1, canonical.find('v') - 1);
+    black = canonical.substr(canonical.find('v') + 2);
+    return true;
+}
+
+// 3 bits per non-king piece kind, wP..wQ then bP..bQ
+uint32_t material_key(const Config& config, bool swap_sides) {
+    uint32_t key = 0;
+    for (int i = 0; i < config.n; ++i) {
+        int piece = swap_sides ? swap_color(config.piece[i]) : config.piece[i];
+        if (piece == wK || piece == bK) continue;
+        key += 1u << (3 * (piece < bP ? piece : piece - 1));
+    }
+    return key;
+}
+
+//----------------------------------------------------------------------
+// Tables
+//----------------------------------------------------------------------
+
+constexpr char MAGIC[8] = {'L', 'U', 'M', 'I', 'N', 'B', 'B', '\0'};
+constexpr uint32_t VERSION = 1;
+constexpr size_t HEADER_BYTES = 64;
+
+struct FileHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t pieces;
+    char name[16];
+    uint64_t entries;
+};
+static_assert(sizeof(FileHeader) <= HEADER_BYTES, "bitbase header overflows its slot");
+
+struct Table {
+    std::string name;
+    int n = 0;
+    uint8_t piece[MAX_PIECES];      // slots: wK, bK, white men, black men
+    bool pawns = false;
+    uint64_t king_regions = 0;
+    uint64_t size = 0;              // entries
+
+    const uint8_t* data = nullptr;  // 2 bits per entry
+    std::vector<uint8_t> owned;     // generated by this process
+    void* mapping = nullptr;        // or mapped from disk
+    size_t mapped_bytes = 0;
+
+    Table(const std::string& white, const std::string& black) {
+        name = "K" + white + "vK" + black;
+        piece[n++] = wK;
+        piece[n++] = bK;
+        for (char c : white) piece[n++] = static_cast<uint8_t>(letter_type(c));
+        for (char c : black) piece[n++] = static_cast<uint8_t>(letter_type(c) + bP);
+        for (int i = 2; i < n; ++i) pawns |= (piece[i] == wP || piece[i] == bP);
+        king_regions = pawns ? 32 : 10;
+        size = 2 * king_regions;
+        for (int i = 1; i < n; ++i) size *= 64;
+    }
+
+    ~Table() {
+        if (mapping) munmap(mapping, mapped_bytes);
+    }
+
+    WDL at(uint64_t index) const {
+        return static_cast<WDL>((data[index >> 2] >> ((index & 3) * 2)) & 3);
+    }
+
+    // Index of the pieces given in slot order, whatever their symmetry
+    uint64_t index(const uint8_t* square, int stm) const {
+        int king = square[0];
+        int symmetries[2], count = 0;
+        if (pawns) {
+            symmetries[count++] = file_of(king) >= 4 ? 1 : 0;
+        } else {
+            int symmetry = (file_of(king) >= 4 ? 1 : 0) | (row_of(king) < 4 ? 2 : 0);
+            int moved = transform(king, symmetry);
+            int file = file_of(moved), rank = 7 - row_of(moved);
+            symmetries[count++] = rank > file ? symmetry | 4 : symmetry;
+            if (rank == file) symmetries[count++] = symmetry | 4;
+        }
+
+        const int8_t* region = pawns ? regions.pawns : regions.pawnless;
+        uint64_t best = UINT64_MAX;
+        for (int k = 0; k < count; ++k) {
+            uint8_t s[MAX_PIECES];
+            for (int i = 0; i < n; ++i) s[i] = static_cast<uint8_t>(transform(square[i], symmetries[k]));
+            // Identical men are interchangeable: keep them in square order
+            for (int i = 3; i < n; ++i) {
+                for (int j = i; j > 2 && piece[j] == piece[j - 1] && s[j] < s[j - 1]; --j) std::swap(s[j], s[j - 1]);
+            }
+            uint64_t idx = static_cast<uint64_t>(stm) * king_regions + region[s[0]];
+            for (int i = 1; i < n; ++i) idx = idx * 64 + s[i];
+            best = std::min(best, idx);
+        }
+        return best;
+    }
+
+    void decode(uint64_t index, uint8_t* square, int& stm) const {
+        for (int i = n - 1; i >= 1; --i) {
+            square[i] = static_cast<uint8_t>(index & 63);
+            index >>= 6;
+        }
+        const uint8_t* region_square = pawns ? regions.pawns_square : regions.pawnless_square;
+        square[0] = region_square[index % king_regions];
+        stm = static_cast<int>(index / king_regions);
+    }
+};
+
+struct Registered {
+    const Table* table;
+    bool swap_sides;    // table is stored with the colors the other way round
+};
+
+std::vector<std::unique_ptr<Table>> tables;
+std::string loaded_directory;
+std::unordered_map<uint32_t, Registered> by_material;
+
+void register_table(std::unique_ptr<Table> table) {
+    Config config;
+    config.n = table->n;
+    std::copy(table->piece, table->piece + table->n, config.piece);
+    by_material[material_key(config, false)] = {table.get(), false};
+    uint32_t swapped = material_key(config, true);
+    if (!by_material.count(swapped)) by_material[swapped] = {table.get(), true};
+    max_pieces = std::max(max_pieces, table->n);
+    tables.push_back(std::move(table));
+}
+
+bool is_registered(const std::string& name) {
+    for (const auto& table : tables) if (table->name == name) return true;
+    return false;
+}
+
+bool lookup(Config config, WDL& result) {
+    if (config.n == 2) {
+        result = Draw;
+        return true;
+    }
+    auto it = by_material.find(material_key(config, false));
+    if (it == by_material.end()) return false;
+    const Table& table = *it->second.table;
+
+    if (it->second.swap_sides) {
+        for (int i = 0; i < config.n; ++i) {
+            config.piece[i] = static_cast<uint8_t>(swap_color(config.piece[i]));
+            config.square[i] ^= 56;
+        }
+        config.stm ^= 1;
+    }
+
+    // Put the pieces in the table's slot order
+    uint8_t square[MAX_PIECES];
+    bool used[MAX_PIECES] = {false, false, false, false};
+    for (int slot = 0; slot < table.n; ++slot) {
+        for (int i = 0; i < config.n; ++i) {
+            if (!used[i] && config.piece[i] == table.piece[slot]) {
+                used[i] = true;
+                square[slot] = config.square[i];
+                break;
+            }
+        }
+    }
+    result = table.at(table.index(square, config.stm));
+    return true;
+}
+
+//----------------------------------------------------------------------
+// Retrograde generation
+//
+// Every entry starts from its forward moves: captures and promotions
+// leave the table and are looked up in the smaller tables built before
+// it, the other moves are counted. Pass p then walks back from the
+// positions decided in pass p - 1: a predecessor of a loss is a win, and
+// a predecessor whose counted moves all turn out to be wins for the
+// opponent (with no drawing exit) is a loss. What is left undecided when
+// a pass changes nothing is a draw.
+//----------------------------------------------------------------------
+
+// Generation state per entry: value, flags, and the pass that decided it
+enum : uint16_t {
+    UNKNOWN = 0, WON = 1, LOST = 2, DRAWN = 3, VALUE = 3,
+    INVALID = 4, DRAW_EXIT = 8
+};
+
+inline uint16_t decided(uint16_t value, int pass) { return static_cast<uint16_t>(value | (pass << 8)); }
+
+template<typename Work>
+void parallel_for(uint64_t size, int threads, Work work) {
+    constexpr uint64_t CHUNK = 4096;
+    std::atomic<uint64_t> next{0};
+    auto run = [&] {
+        for (;;) {
+            uint64_t begin = next.fetch_add(CHUNK, std::memory_order_relaxed);
+            if (begin >= size) return;
+            uint64_t end = std::min(size, begin + CHUNK);
+            for (uint64_t i = begin; i < end; ++i) work(i);
+        }
+    };
+    std::vector<std::thread> pool;
+    for (int t = 1; t < threads; ++t) pool.emplace_back(run);
+    run();
+    for (std::thread& thread : pool) thread.join();
+}
+
+// Distinct entries, for up to a few dozen moves
+struct IndexSet {
+    uint64_t items[128];
+    int count = 0;
+    void insert(uint64_t idx) {
+        for (int i = 0; i < count; ++i) if (items[i] == idx) return;
+        items[count++] = idx;
+    }
+};
+
+class Generator {
+public:
+    Generator(const Table& table, int threads)
+        : table(table), threads(threads),
+          state(new std::atomic<uint16_t>[table.size]),
+          moves_left(new std::atomic<uint8_t>[table.size]) {}
+
+    std::vector<uint8_t> run(uint64_t counts[3]) {
+        parallel_for(table.size, threads, [&](uint64_t i) { initialize(i); });
+
+        for (int pass = 1; pass < 256; ++pass) {
+            std::atomic<bool> changed{false};
+            parallel_for(table.size, threads, [&](uint64_t i) {
+                uint16_t s = state[i].load(std::memory_order_relaxed);
+                if ((s >> 8) != pass - 1 || (s & INVALID)) return;
+                if ((s & VALUE) == WON || (s & VALUE) == LOST) {
+                    if (retract(i, (s & VALUE) == LOST, pass)) changed.store(true, std::memory_order_relaxed);
+                }
+            });
+            if (!changed.load()) break;
+        }
+
+        std::vector<uint8_t> packed((table.size + 3) / 4, 0);
+        counts[Draw] = counts[Win] = counts[Loss] = 0;
+        for (uint64_t i = 0; i < table.size; ++i) {
+            uint16_t s = state[i].load(std::memory_order_relaxed);
+            if (s & INVALID) continue;
+            WDL value = (s & VALUE) == WON ? Win : (s & VALUE) == LOST ? Loss : Draw;
+            packed[i >> 2] |= static_cast<uint8_t>(value << ((i & 3) * 2));
+            ++counts[value];
+        }
+        return packed;
+    }
+
+private:
+    const Table& table;
+    int threads;
+    std::unique_ptr<std::atomic<uint16_t>[]> state;
+    std::unique_ptr<std::atomic<uint8_t>[]> moves_left;
+
+    bool valid(uint64_t i, const uint8_t* square, int stm) const {
+        U64 seen = 0ULL;
+        for (int k = 0; k < table.n; ++k) {
+            if ((seen >> square[k]) & 1) return false;
+            seen |= 1ULL << square[k];
+            if ((table.piece[k] == wP || table.piece[k] == bP) && (row_of(square[k]) == 0 || row_of(square[k]) == 7))
+                return false;
+        }
+        if (table.index(square, stm) != i) return false;
+        // The side that just moved cannot have left its king in check
+        return !attacked(square[stm ^ 1], stm, table.piece, square, table.n);
+    }
+
+    void initialize(uint64_t i) {
+        uint8_t square[MAX_PIECES];
+        int stm;
+        table.decode(i, square, stm);
+        moves_left[i].store(0, std::memory_order_relaxed);
+        if (!valid(i, square, stm)) {
+            state[i].store(INVALID, std::memory_order_relaxed);
+            return;
+        }
+
+        IndexSet successors;
+        bool legal = false, win_exit = false, draw_exit = false;
+        const int n = table.n;
+        const U64 occupancy = occupancy_of(square, n);
+        U64 own = 0ULL;
+        for (int k = 0; k < n; ++k) if (color_of(table.piece[k]) == stm) own |= 1ULL << square[k];
+
+        auto play = [&](int k, int to, int promoted) {
+            Config next;
+            next.stm = stm ^ 1;
+            bool exit = promoted != table.piece[k];
+            for (int j = 0; j < n; ++j) {
+                if (j != k && square[j] == to) { exit = true; continue; }   // captured
+                next.piece[next.n] = j == k ? static_cast<uint8_t>(promoted) : table.piece[j];
+                next.square[next.n++] = j == k ? static_cast<uint8_t>(to) : square[j];
+            }
+            int king = 0;
+            while (next.piece[king] != (stm == White ? wK : bK)) ++king;
+            if (attacked(next.square[king], stm ^ 1, next.piece, next.square, next.n)) return;
+            legal = true;
+
+            if (!exit) {
+                successors.insert(table.index(next.square, stm ^ 1));
+                return;
+            }
+            WDL result = Draw;
+            lookup(next, result);
+            if (result == Loss) win_exit = true;
+            else if (result == Draw) draw_exit = true;
+        };
+
+        for (int k = 0; k < n; ++k) {
+            int piece = table.piece[k];
+            if (color_of(piece) != stm) continue;
+            int from = square[k];
+            U64 targets;
+            if (piece % bP == wP) {
+                int step = stm == White ? -8 : 8;
+                targets = attacks_from(piece, from, occupancy) & occupancy & ~own;
+                if (!((occupancy >> (from + step)) & 1)) {
+                    targets |= 1ULL << (from + step);
+                    int start_row = stm == White ? 6 : 1;
+                    if (row_of(from) == start_row && !((occupancy >> (from + 2 * step)) & 1))
+                        targets |= 1ULL << (from + 2 * step);
+                }
+            } else {
+                targets = attacks_from(piece, from, occupancy) & ~own;
+            }
+            while (targets) {
+                int to = get_ls1b_index(targets);
+                targets &= targets - 1;
+                if (piece % bP == wP && (row_of(to) == 0 || row_of(to) == 7)) {
+                    for (int promoted = wQ; promoted >= wN; --promoted) play(k, to, promoted + (piece - wP));
+                } else {
+                    play(k, to, piece);
+                }
+            }
+        }
+
+        uint16_t flags = draw_exit ? DRAW_EXIT : 0;
+        bool in_check = attacked(square[stm], stm ^ 1, table.piece, square, n);
+        uint16_t value;
+        if (!legal)                 value = in_check ? decided(LOST, 0) : uint16_t(DRAWN);
+        else if (win_exit)          value = decided(WON, 0);
+        else if (successors.count)  value = UNKNOWN;
+        else                        value = draw_exit ? uint16_t(DRAWN) : decided(LOST, 0);
+        moves_left[i].store(static_cast<uint8_t>(successors.count), std::memory_order_relaxed);
+        state[i].store(static_cast<uint16_t>(value | flags), std::memory_order_relaxed);
+    }
+
+    // Positions one move before entry i; true when any of them got decided
+    bool retract(uint64_t i, bool lost, int pass) {
+        uint8_t square[MAX_PIECES];
+        int stm;
+        table.decode(i, square, stm);
+        const int mover = stm ^ 1;
+        const int n = table.n;
+        const U64 occupancy = occupancy_of(square, n);
+
+        IndexSet predecessors;
+        for (int k = 0; k < n; ++k) {
+            int piece = table.piece[k];
+            if (color_of(piece) != mover) continue;
+            int to = square[k];
+            U64 origins;
+            if (piece % bP == wP) {
+                int back = mover == White ? 8 : -8;
+                int from = to + back;
+                origins = 0ULL;
+                if (row_of(from) >= 1 && row_of(from) <= 6 && !((occupancy >> from) & 1)) {
+                    origins |= 1ULL << from;
+                    int double_row = mover == White ? 4 : 3;
+                    if (row_of(to) == double_row && !((occupancy >> (from + back)) & 1))
+                        origins |= 1ULL << (from + back);
+                }
+            } else {
+                origins = attacks_from(piece, to, occupancy) & ~occupancy;
+            }
+            while (origins) {
+                uint8_t before[MAX_PIECES];
+                std::copy(square, square + n, before);
+                before[k] = static_cast<uint8_t>(get_ls1b_index(origins));
+                origins &= origins - 1;
+                // The side to move here was not to move before: not in check
+                if (attacked(before[stm], mover, table.piece, before, n)) continue;
+                predecessors.insert(table.index(before, mover));
+            }
+        }
+
+        bool changed = false;
+        for (int p = 0; p < predecessors.count; ++p) {
+            uint64_t j = predecessors.items[p];
+            uint16_t current = state[j].load(std::memory_order_relaxed);
+            if ((current & VALUE) != UNKNOWN || (current & INVALID)) continue;
+            if (lost) {
+                changed |= settle(j, WON, pass);
+            } else if (moves_left[j].fetch_sub(1, std::memory_order_relaxed) == 1 && !(current & DRAW_EXIT)) {
+                changed |= settle(j, LOST, pass);
+            }
+        }
+        return changed;
+    }
+
+    bool settle(uint64_t j, uint16_t value, int pass) {
+        uint16_t current = state[j].load(std::memory_order_relaxed);
+        while ((current & VALUE) == UNKNOWN) {
+            uint16_t next = static_cast<uint16_t>(decided(value, pass) | (current & DRAW_EXIT));
+            if (state[j].compare_exchange_weak(current, next, std::memory_order_relaxed)) return true;
+        }
+        return false;
+    }
+};
+
+// Tables reached by captures and promotions, by name
+std::vector<std::string> dependencies(const std::string& white, const std::string& black) {
+    std::set<std::string> names;
+    for (int side = 0; side < 2; ++side) {
+        const std::string& us = side == 0 ? white : black;
+        const std::string& them = side == 0 ? black : white;
+        auto add = [&](const std::string& a, const std::string& b) {
+            if (!a.empty() || !b.empty()) names.insert(side == 0 ? make_name(a, b) : make_name(b, a));
+        };
+        for (size_t c = 0; c < them.size(); ++c) {
+            std::string captured = them;
+            captured.erase(c, 1);
+            add(us, captured);
+            size_t pawn = us.find('P');
+            if (pawn == std::string::npos) continue;
+            for (char promoted : std::string("QRBN")) {
+                std::string crowned = us;
+                crowned[pawn] = promoted;
+                add(crowned, captured);
+            }
+        }
+        size_t pawn = us.find('P');
+        if (pawn == std::string::npos) continue;
+        for (char promoted : std::string("QRBN")) {
+            std::string crowned = us;
+            crowned[pawn] = promoted;
+            add(crowned, them);
+        }
+    }
+    return std::vector<std::string>(names.begin(), names.end());
+}
+
+// Every table up to MAX_PIECES, smallest first
+std::vector<std::string> all_names() {
+    std::vector<std::string> men = {""};
+    for (int a = 4; a >= 0; --a) {
+        men.push_back(std::string(1, LETTERS[a]));
+        for (int b = a; b >= 0; --b) men.push_back(std::string(1, LETTERS[a]) + LETTERS[b]);
+    }
+    std::set<std::pair<size_t, std::string>> names;
+    for (const std::string& white : men) {
+        for (const std::string& black : men) {
+            size_t count = white.size() + black.size();
+            if (count >= 1 && count + 2 <= static_cast<size_t>(MAX_PIECES))
+                names.insert({count, make_name(white, black)});
+        }
+    }
+    std::vector<std::string> result;
+    for (const auto& entry : names) result.push_back(entry.second);
+    return result;
+}
+
+bool write_table(const std::string& path, const Table& table) {
+    std::ofstream out(path, std::ios::binary);
+    if (!out) return false;
+    char header[HEADER_BYTES] = {};
+    FileHeader info{};
+    std::memcpy(info.magic, MAGIC, sizeof(MAGIC));
+    info.version = VERSION;
+    info.pieces = static_cast<uint32_t>(table.n);
+    std::strncpy(info.name, table.name.c_str(), sizeof(info.name) - 1);
+    info.entries = table.size;
+    std::memcpy(header, &info, sizeof(info));
+    out.write(header, HEADER_BYTES);
+    out.write(reinterpret_cast<const char*>(table.data), static_cast<std::streamsize>((table.size + 3) / 4));
+    return static_cast<bool>(out);
+}
+
+std::unique_ptr<Table> map_table(const std::string& path) {
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) return nullptr;
+    struct stat info;
+    size_t bytes = (fstat(fd, &info) == 0) ? static_cast<size_t>(info.st_size) : 0;
+    void* mapping = bytes >= HEADER_BYTES ? mmap(nullptr, bytes, PROT_READ, MAP_PRIVATE, fd, 0) : MAP_FAILED;
+    ::close(fd);
+    if (mapping == MAP_FAILED) return nullptr;
+
+    FileHeader header;
+    std::memcpy(&header, mapping, sizeof(header));
+    header.name[sizeof(header.name) - 1] = '\0';
+    std::string white, black;
+    if (std::memcmp(header.magic, MAGIC, sizeof(MAGIC)) != 0 || header.version != VERSION
+        || !parse_name(header.name, white, black) || make_name(white, black) != header.name) {
+        munmap(mapping, bytes);
+        return nullptr;
+    }
+
+    auto table = std::make_unique<Table>(white, black);
+    if (static_cast<uint32_t>(table->n) != header.pieces || table->size != header.entries
+        || bytes < HEADER_BYTES + (table->size + 3) / 4) {
+        munmap(mapping, bytes);
+        return nullptr;
+    }
+    // Probes land anywhere in the table
+    madvise(mapping, bytes, MADV_RANDOM);
+    table->mapping = mapping;
+    table->mapped_bytes = bytes;
+    table->data = static_cast<const uint8_t*>(mapping) + HEADER_BYTES;
+    return table;
+}
+
+bool build(const std::string& dir, const std::string& name, int threads) {
+    if (is_registered(name)) return true;
+    std::string white, black;
+    parse_name(name, white, black);
+    for (const std::string& dependency : dependencies(white, black)) {
+        if (!build(dir, dependency, threads)) return false;
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    auto table = std::make_unique<Table>(white, black);
+    uint64_t counts[3];
+    table->owned = Generator(*table, threads).run(counts);
+    table->data = table->owned.data();
+    auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count();
+
+    std::string path = dir + "/" + name + ".lbb";
+    if (!write_table(path, *table)) {
+        std::cerr << "Cannot write " << path << "\n";
+        return false;
+    }
+    std::cerr << name << ": " << counts[Win] << " wins, " << counts[Draw] << " draws, "
+              << counts[Loss] << " losses (" << ms << " ms)\n";
+    register_table(std::move(table));
+    return true;
+}
+
+} // namespace
+
+//----------------------------------------------------------------------
+// Interface
+//----------------------------------------------------------------------
+
+int load(const std::string& dir) {
+    unload();
+    DIR* directory = opendir(dir.c_str());
+    if (!directory) return 0;
+    std::vector<std::string> files;
+    while (dirent* entry = readdir(directory)) {
+        std::string file = entry->d_name;
+        if (file.size() > 4 && file.compare(file.size() - 4, 4, ".lbb") == 0) files.push_back(file);
+    }
+    closedir(directory);
+
+    std::sort(files.begin(), files.end());
+    loaded_directory = dir;
+    for (const std::string& file : files) {
+        std::unique_ptr<Table> table = map_table(dir + "/" + file);
+        if (!table) {
+            std::cerr << "Ignoring invalid bitbase " << dir << "/" << file << "\n";
+            continue;
+        }
+        if (!is_registered(table->name)) register_table(std::move(table));
+    }
+    return static_cast<int>(tables.size());
+}
+
+void unload() {
+    by_material.clear();
+    tables.clear();
+    loaded_directory.clear();
+    max_pieces = 0;
+}
+
+const std::string& directory() {
+    return loaded_directory;
+}
+
+bool probe(const Position& position, WDL& result) {
+    if (position.castling || position.enpassant != no_sq) return false;
+    Config config;
+    for (int piece = wP; piece <= bK; ++piece) {
+        for (U64 bb = position.bitboards[piece]; bb; bb &= bb - 1) {
+            if (config.n == MAX_PIECES) return false;
+            config.piece[config.n] = static_cast<uint8_t>(piece);
+            config.square[config.n++] = static_cast<uint8_t>(get_ls1b_index(bb));
+        }
+    }
+    config.stm = position.SideToMove;
+    return lookup(config, result);
+}
+
+bool generate(const std::string& dir, const std::vector<std::string>& names, int threads) {
+    std::vector<std::string> wanted;
+    for (const std::string& name : names) {
+        if (name == "all") {
+            for (const std::string& each : all_names()) wanted.push_back(each);
+            continue;
+        }
+        std::string white, black;
+        if (!parse_name(name, white, black) || (white.empty() && black.empty())) {
+            std::cerr << "Unknown bitbase " << name << "\n";
+            return false;
+        }
+        wanted.push_back(make_name(white, black));
+    }
+    for (const std::string& name : wanted) {
+        if (!build(dir, name, std::max(1, threads))) return false;
+    }
+    return true;
+}
+
+} // namespace Bitbase
+
+static void print_bitbase_usage() {
+    std::cerr << "Usage: lumin bitbase generate <dir> [all | KRvK KPvK ...] [--threads N]\n"
+                 "       lumin bitbase probe <dir> <fen>\n";
+}
+
+int bitbase_main(const std::vector<std::string>& args) {
+    if (args.size() < 2) {
+        print_bitbase_usage();
+        return 1;
+    }
+    const std::string& command = args[0];
+    const std::string& dir = args[1];
+
+    if (command == "generate") {
+        std::vector<std::string> names;
+        int threads = static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+        for (size_t i = 2; i < args.size(); ++i) {
+            if (args[i] == "--threads" && i + 1 < args.size()) threads = std::atoi(args[++i].c_str());
+            else names.push_back(args[i]);
+        }
+        if (names.empty()) names.push_back("all");
+        if (mkdir(dir.c_str(), 0755) != 0 && errno != EEXIST) {
+            std::cerr << "Cannot create " << dir << "\n";
+            return 1;
+        }
+        Bitbase::load(dir);
+        return Bitbase::generate(dir, names, threads) ? 0 : 1;
+    }
+
+    if (command == "probe" && args.size() >= 3) {
+        std::string fen;
+        for (size_t i = 2; i < args.size(); ++i) fen += (i > 2 ? " " : "") + args[i];
+        Position position;
+        FenError error = parse_fen(fen, position);
+        if (error != FenError::None) {
+            std::cerr << "Invalid FEN (" << fen_error_string(error) << ")\n";
+            return 1;
+        }
+        int loaded = Bitbase::load(dir);
+        Bitbase::WDL result;
+        if (!Bitbase::probe(position, result)) {
+            std::cout << "not in the bitbases (" << loaded << " tables loaded)\n";
+            return 1;
+        }
+        const char* names[] = {"draw", "win", "loss"};
+        std::cout << names[result] << " for " << (position.SideToMove == White ? "white" : "black") << "\n";
+        return 0;
+    }
+
+    print_bitbase_usage();
+    return 1;
+}
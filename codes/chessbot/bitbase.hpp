@@ -0,0 +1,55 @@
+#ifndef BITBASE_HPP
+#define BITBASE_HPP
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "position.hpp"
+
+//----------------------------------------------------------------------
+// Endgame bitbases
+//
+// Win / draw / loss for every position of an endgame with up to four
+// pieces (kings included), side to move's point of view, 2 bits each.
+// Tables are built in-engine by retrograde analysis ("lumin bitbase
+// generate <dir>") and written as <name>.lbb, e.g. KRvKP.lbb, with the
+// stronger side as White. The search maps them read-only and probes them
+// once few enough pieces are left.
+//
+// Castling and en passant are not part of the tables: positions with
+// either right are not probed.
+//----------------------------------------------------------------------
+
+namespace Bitbase {
+    enum WDL : uint8_t { Draw = 0, Win = 1, Loss = 2 };
+
+    constexpr int MAX_PIECES = 4;
+
+    // Piece count covered by the loaded tables (0 = none), checked by the
+    // search before doing any work
+    extern int max_pieces;
+
+    // Maps every .lbb file of `dir`; returns how many tables were loaded
+    int load(const std::string& dir);
+    void unload();
+
+    // Directory of the loaded tables, empty when none are
+    const std::string& directory();
+
+    // Result for the side to move; false when no loaded table covers it
+    bool probe(const Position& position, WDL& result);
+
+    // Builds the named tables ("all" for every 3 and 4 piece ending) plus
+    // whatever they depend on, into `dir`. Tables already loaded are
+    // reused. Returns false on an unknown name or an I/O error.
+    bool generate(const std::string& dir, const std::vector<std::string>& names, int threads);
+}
+
+// lumin bitbase generate <dir> [all | KRvK KPvK ...] [--threads N]
+// lumin bitbase probe <dir> <fen>
+//
+// Generation loads what <dir> already holds and only builds the missing
+// tables. Returns the process exit code.
+int bitbase_main(const std::vector<std::string>& args);
+
+#endif // BITBASE_HPP
@@ -0,0 +1,64 @@
+#ifndef BOOK_HPP
+#define BOOK_HPP
+
+#include <cstddef>
+#include <string>
+#include <vector>
+#include "position.hpp"
+#include "movedef.hpp"
+#include "types.hpp"
+
+//----------------------------------------------------------------------
+// Polyglot opening book
+//
+// A .bin book is an array of 16-byte big-endian entries
+//   key (64) | move (16) | weight (16) | learn (32)
+// sorted by key, where key is the Polyglot hash of the position (its own
+// Zobrist scheme, independent of the engine's). The file is memory-mapped
+// and searched in place: a lookup is one binary search plus a scan over
+// the entries of that key, with no parsing at load time.
+//----------------------------------------------------------------------
+
+namespace Polyglot {
+    U64 key(const Position& position);
+}
+
+struct BookMove {
+    Move move;
+    int weight;
+};
+
+class OpeningBook {
+public:
+    OpeningBook() = default;
+    ~OpeningBook() { close(); }
+
+    OpeningBook(const OpeningBook&) = delete;
+    OpeningBook& operator=(const OpeningBook&) = delete;
+
+    // Maps the file; false (and no book) when it cannot be read
+    bool open(const std::string& path);
+    void close();
+
+    bool is_open() const { return entries != nullptr; }
+    size_t size() const { return count; }
+    const std::string& path() const { return file_path; }
+
+    // Legal book moves of the position with their weights, book order
+    std::vector<BookMove> moves(const Position& position) const;
+
+    // A book move picked at random in proportion to its weight
+    // (the heaviest one when `best`), 0 when out of book
+    Move probe(const Position& position, bool best = false) const;
+
+private:
+    const unsigned char* entries = nullptr;
+    size_t count = 0;
+    size_t mapped_bytes = 0;
+    std::string file_path;
+};
+
+// Book used by the game loop and the UCI "go" handler (closed by default)
+extern OpeningBook book;
+
+#endif // BOOK_HPP
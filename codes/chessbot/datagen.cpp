@@ -0,0 +1,414 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <thread>
+#include <unordered_map>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "datagen.hpp"
+#include "attacks.hpp"
+#include "bitboard.hpp"
+#include "game.hpp"
+#include "search.hpp"
+#include "tt.hpp"
+#include "zobrist.hpp"
+
+namespace Datagen {
+
+//----------------------------------------------------------------------
+// Records
+//----------------------------------------------------------------------
+
+PackedPosition pack(const Position& position, int white_score, int white_result) {
+    PackedPosition record{};
+    record.occupancy = position.occupancies[Both];
+
+    int index = 0;
+    for (U64 occupied = record.occupancy; occupied; occupied &= occupied - 1) {
+        int sq = get_ls1b_index(occupied);
+        int piece = 0;
+        while (!get_bit(position.bitboards[piece], sq)) ++piece;
+        record.pieces[index / 2] |= static_cast<uint8_t>(piece << (4 * (index & 1)));
+        ++index;
+    }
+
+    record.score = static_cast<int16_t>(std::clamp(white_score, -32000, 32000));
+    record.result = static_cast<int8_t>(white_result);
+    record.side_to_move = static_cast<uint8_t>(position.SideToMove);
+    record.castling = position.castling;
+    record.enpassant = position.enpassant;
+    record.halfmove = static_cast<uint8_t>(std::min<int>(position.halfmove, 255));
+    return record;
+}
+
+bool unpack(const PackedPosition& record, Position& position) {
+    position.emptyBoard();
+    int index = 0;
+    for (U64 occupied = record.occupancy; occupied; occupied &= occupied - 1) {
+        if (index >= 32) return false;
+        int piece = (record.pieces[index / 2] >> (4 * (index & 1))) & 0xF;
+        if (piece >= Em) return false;
+        set_bit(position.bitboards[piece], get_ls1b_index(occupied));
+        ++index;
+    }
+    position.compute_occupancies();
+
+    position.SideToMove = record.side_to_move == Black ? Black : White;
+    position.castling = record.castling & 0xF;
+    position.enpassant = record.enpassant < 64 ? int(record.enpassant) : int(no_sq);
+    position.halfmove = record.halfmove;
+    position.fullmove = 1;
+    position.FiftyMove = false;
+    position.hash_key = generate_hash_key(position);
+    position.move_list.clear();
+    return true;
+}
+
+bool DataFile::open(const std::string& path) {
+    close();
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) return false;
+
+    struct stat info;
+    size_t bytes = (fstat(fd, &info) == 0) ? static_cast<size_t>(info.st_size) : 0;
+    bool whole = bytes > 0 && bytes % sizeof(PackedPosition) == 0;
+    void* mapping = whole ? mmap(nullptr, bytes, PROT_READ, MAP_PRIVATE, fd, 0) : MAP_FAILED;
+    ::close(fd);
+    if (mapping == MAP_FAILED) return false;
+
+    // Training passes stream the file front to back
+    madvise(mapping, bytes, MADV_SEQUENTIAL);
+    records = static_cast<const PackedPosition*>(mapping);
+    count = bytes / sizeof(PackedPosition);
+    return true;
+}
+
+void DataFile::close() {
+    if (records) munmap(const_cast<PackedPosition*>(records), count * sizeof(PackedPosition));
+    records = nullptr;
+    count = 0;
+}
+
+} // namespace Datagen
+
+//----------------------------------------------------------------------
+// Self-play
+//----------------------------------------------------------------------
+
+using Datagen::PackedPosition;
+
+namespace {
+
+constexpr int MAX_GAME_PLIES = 400;
+// Both sides agreeing on a score this large for WIN_PLIES plies ends the
+// game; such positions are not kept, their score says little
+constexpr int WIN_SCORE = 1500;
+constexpr int WIN_PLIES = 4;
+// A dead level game past DRAW_START plies is called a draw
+constexpr int DRAW_START = 80;
+constexpr int DRAW_SCORE = 10;
+constexpr int DRAW_PLIES = 8;
+// Records per worker between writes (128 KiB)
+constexpr size_t BUFFER_RECORDS = 4096;
+
+struct DatagenOptions {
+    SearchLimits limits;
+    uint64_t max_positions = 0;
+    uint64_t max_games = 0;
+    int random_plies = 8;
+    uint64_t seed = 0;
+};
+
+struct DatagenTotals {
+    std::atomic<uint64_t> games_started{0};
+    std::atomic<uint64_t> games{0};
+    std::atomic<uint64_t> positions{0};
+    std::atomic<uint64_t> results[3] = {};     // black wins, draws, white wins
+    std::atomic<bool> write_failed{false};
+};
+
+// Output shared by the workers: each hands over a full buffer at a time,
+// so the file is written in large sequential blocks
+class RecordWriter {
+public:
+    explicit RecordWriter(FILE* out) : file(out) {}
+
+    bool write(const std::vector<PackedPosition>& records) {
+        std::lock_guard<std::mutex> lk(lock);
+        return std::fwrite(records.data(), sizeof(PackedPosition), records.size(), file) == records.size();
+    }
+
+private:
+    FILE* file;
+    std::mutex lock;
+};
+
+bool in_check(const Position& position) {
+    int king = get_ls1b_index(position.bitboards[position.SideToMove == White ? wK : bK]);
+    return isSquareAttacked(king, position, position.SideToMove ^ 1);
+}
+
+// A few uniformly random plies from the start position; false when the
+// game ended on the way
+bool random_opening(Position& position, int plies, std::mt19937_64& rng) {
+    position = Position();
+    position.generate_moves();
+    for (int ply = 0; ply < plies; ++ply) {
+        if (position.move_list.empty()) return false;
+        std::uniform_int_distribution<size_t> pick(0, position.move_list.size() - 1);
+        position = makemove(position.move_list[pick(rng)], position);
+        position.generate_moves();
+    }
+    return !position.move_list.empty();
+}
+
+// Plays one game and appends its quiet positions to `records`; returns
+// the result for White
+int play_game(const DatagenOptions& options, std::mt19937_64& rng, TranspositionTable& table,
+              std::vector<PackedPosition>& records) {
+    Position position;
+    while (!random_opening(position, options.random_plies, rng)) {}
+    table.clear();
+
+    const size_t first = records.size();
+    std::unordered_map<U64, int> seen;
+    seen[position.hash_key] = 1;
+    int result = 0;
+    int win_streak = 0, draw_streak = 0, last_sign = 0;
+
+    for (int ply = 0; ; ++ply) {
+        if (position.move_list.empty()) {
+            if (in_check(position)) result = position.SideToMove == White ? -1 : 1;
+            break;
+        }
+        if (ply >= MAX_GAME_PLIES || position.halfmove >= 100
+            || Game::isDrawByInsufficientMaterial(position) || seen[position.hash_key] >= 3) break;
+
+        std::vector<PVLine> lines;
+        Move best = findbestmove(position, options.limits, SearchOutput::Silent, &lines);
+        if (!best) break;
+        // No iteration finished within the node budget: play the move, keep no sample
+        if (lines.empty()) {
+            position = makemove(best, position);
+            position.generate_moves();
+            seen[position.hash_key] += 1;
+            continue;
+        }
+        int score = lines.front().score;
+        int white_score = position.SideToMove == White ? score : -score;
+
+        // Adjudication
+        int sign = (white_score > 0) - (white_score < 0);
+        win_streak = (std::abs(score) >= WIN_SCORE && (win_streak == 0 || sign == last_sign)) ? win_streak + 1 : 0;
+        last_sign = sign;
+        if (win_streak >= WIN_PLIES) {
+            result = sign;
+            break;
+        }
+        draw_streak = (ply >= DRAW_START && std::abs(score) <= DRAW_SCORE) ? draw_streak + 1 : 0;
+        if (draw_streak >= DRAW_PLIES) break;
+
+        // Keep quiet positions only: the static evaluation a tuner fits
+        // cannot see a capture or a check about to be resolved
+        bool quiet = !in_check(position) && !get_move_capture_flag(best)
+                  && get_move_promoted(best) == get_move_piece(best);
+        if (quiet && std::abs(score) < WIN_SCORE) records.push_back(Datagen::pack(position, white_score, 0));
+
+        position = makemove(best, position);
+        position.generate_moves();
+        seen[position.hash_key] += 1;
+    }
+
+    for (size_t i = first; i < records.size(); ++i) records[i].result = static_cast<int8_t>(result);
+    return result;
+}
+
+bool limits_reached(const DatagenOptions& options, DatagenTotals& totals) {
+    return (options.max_positions && totals.positions >= options.max_positions)
+        || (options.max_games && totals.games_started >= options.max_games);
+}
+
+void datagen_worker(int id, int jobs, const DatagenOptions& options, TranspositionTable& shared_table,
+                    RecordWriter& writer, DatagenTotals& totals) {
+    TranspositionTable table(shared_table, id, jobs);
+    TimeManager timer;
+    auto stats = std::make_unique<SearchStats::Group>();
+    set_search_context(SearchContext{&table, &timer, stats.get()});
+
+    std::mt19937_64 rng(options.seed + 0x9E3779B97F4A7C15ULL * static_cast<uint64_t>(id + 1));
+    std::vector<PackedPosition> buffer;
+    buffer.reserve(BUFFER_RECORDS + MAX_GAME_PLIES);
+
+    auto flush = [&]() {
+        if (!buffer.empty() && !writer.write(buffer)) totals.write_failed = true;
+        buffer.clear();
+    };
+
+    while (!totals.write_failed && !limits_reached(options, totals)) {
+        if (options.max_games && totals.games_started++ >= options.max_games) break;
+        size_t before = buffer.size();
+        int result = play_game(options, rng, table, buffer);
+
+        totals.games += 1;
+        totals.positions += buffer.size() - before;
+        totals.results[result + 1] += 1;
+        if (buffer.size() >= BUFFER_RECORDS) flush();
+    }
+    flush();
+}
+
+void print_datagen_usage() {
+    std::cerr << "Usage: lumin datagen --out <file> [--positions N] [--games N] [--nodes N]"
+                 " [--threads T] [--random-plies P] [--hash MB] [--seed S]\n"
+                 "       lumin datagen stats <file> [--show N]\n";
+}
+
+int datagen_stats(const std::vector<std::string>& args) {
+    std::string path;
+    size_t show = 0;
+    for (size_t i = 1; i < args.size(); ++i) {
+        if (args[i] == "--show" && i + 1 < args.size()) show = std::strtoull(args[++i].c_str(), nullptr, 10);
+        else if (path.empty()) path = args[i];
+        else {
+            print_datagen_usage();
+            return 1;
+        }
+    }
+
+    Datagen::DataFile file;
+    if (path.empty() || !file.open(path)) {
+        std::cerr << "Cannot map " << path << " as a data file\n";
+        return 1;
+    }
+
+    uint64_t results[3] = {0, 0, 0}, invalid = 0;
+    double abs_score = 0.0;
+    Position position;
+    for (size_t i = 0; i < file.size(); ++i) {
+        const PackedPosition& record = file[i];
+        if (!Datagen::unpack(record, position) || record.result < -1 || record.result > 1) {
+            ++invalid;
+            continue;
+        }
+        results[record.result + 1] += 1;
+        abs_score += std::abs(record.score);
+        if (i < show) std::cout << position.get_fen() << " | " << record.score << " | " << int(record.result) << "\n";
+    }
+
+    uint64_t valid = file.size() - invalid;
+    std::cout << "Positions: " << file.size() << " (" << invalid << " invalid)\n"
+              << "Results (White): " << results[2] << " wins, " << results[1] << " draws, "
+              << results[0] << " losses\n"
+              << "Mean |score|: " << std::fixed << std::setprecision(1)
+              << (valid ? abs_score / valid : 0.0) << " cp\n";
+    return invalid ? 1 : 0;
+}
+
+} // namespace
+
+//----------------------------------------------------------------------
+// lumin datagen
+//----------------------------------------------------------------------
+
+int datagen_main(const std::vector<std::string>& args) {
+    if (!args.empty() && args[0] == "stats") return datagen_stats(args);
+
+    std::string out_path;
+    DatagenOptions options;
+    options.limits.nodes = 5000;
+    options.seed = std::random_device{}();
+    int jobs = std::max(1u, std::thread::hardware_concurrency());
+    int hash_mb = 64;
+
+    for (size_t i = 0; i < args.size(); ++i) {
+        const std::string& arg = args[i];
+        bool has_value = i + 1 < args.size();
+        if      (arg == "--out" && has_value)          out_path = args[++i];
+        else if (arg == "--positions" && has_value)    options.max_positions = std::strtoull(args[++i].c_str(), nullptr, 10);
+        else if (arg == "--games" && has_value)        options.max_games = std::strtoull(args[++i].c_str(), nullptr, 10);
+        else if (arg == "--nodes" && has_value)        options.limits.nodes = std::strtoull(args[++i].c_str(), nullptr, 10);
+        else if (arg == "--threads" && has_value)      jobs = std::atoi(args[++i].c_str());
+        else if (arg == "--random-plies" && has_value) options.random_plies = std::atoi(args[++i].c_str());
+        else if (arg == "--hash" && has_value)         hash_mb = std::atoi(args[++i].c_str());
+        else if (arg == "--seed" && has_value)         options.seed = std::strtoull(args[++i].c_str(), nullptr, 10);
+        else {
+            print_datagen_usage();
+            return 1;
+        }
+    }
+
+    if (out_path.empty() || options.limits.nodes == 0 || (!options.max_positions && !options.max_games)) {
+        print_datagen_usage();
+        return 1;
+    }
+    jobs = std::clamp(jobs, 1, SearchStats::MAX_THREADS);
+    options.random_plies = std::max(0, options.random_plies);
+
+    // Appending: runs with different seeds grow one file
+    FILE* out = std::fopen(out_path.c_str(), "ab");
+    if (!out) {
+        std::cerr << "Cannot write " << out_path << "\n";
+        return 1;
+    }
+    std::vector<char> io_buffer(1 << 20);
+    std::setvbuf(out, io_buffer.data(), _IOFBF, io_buffer.size());
+
+    // Each worker runs plain single-threaded, single-PV searches
+    search_threads = 1;
+    multi_pv = 1;
+
+    TranspositionTable shared_table(std::max(1, hash_mb));
+    RecordWriter writer(out);
+    DatagenTotals totals;
+
+    auto t0 = std::chrono::steady_clock::now();
+    auto seconds_since_start = [&]() {
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+    };
+    std::vector<std::thread> workers;
+    for (int id = 0; id < jobs; ++id) {
+        workers.emplace_back(datagen_worker, id, jobs, std::cref(options), std::ref(shared_table),
+                             std::ref(writer), std::ref(totals));
+    }
+
+    // Progress every few seconds while the workers run
+    std::atomic<bool> finished{false};
+    std::thread progress([&]() {
+        auto next_report = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+        while (!finished) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(100));
+            if (std::chrono::steady_clock::now() < next_report) continue;
+            next_report += std::chrono::seconds(5);
+            double seconds = seconds_since_start();
+            std::cerr << totals.games << " games, " << totals.positions << " positions, "
+                      << static_cast<uint64_t>(totals.positions / seconds) << " pos/s\n";
+        }
+    });
+    for (std::thread& worker : workers) worker.join();
+    finished = true;
+    progress.join();
+
+    bool ok = std::fclose(out) == 0 && !totals.write_failed;
+    double seconds = seconds_since_start();
+    std::cerr << "Generated " << totals.positions << " positions from " << totals.games << " games with "
+              << jobs << " thread(s) in " << std::fixed << std::setprecision(1) << seconds << " s, "
+              << static_cast<uint64_t>(seconds > 0 ? totals.positions / seconds : 0) << " pos/s\n"
+              << "Results (White): " << totals.results[2] << " wins, " << totals.results[1] << " draws, "
+              << totals.results[0] << " losses\n";
+    if (!ok) {
+        std::cerr << "Writing " << out_path << " failed\n";
+        return 1;
+    }
+    return 0;
+}
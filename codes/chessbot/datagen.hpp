@@ -0,0 +1,79 @@
+#ifndef DATAGEN_HPP
+#define DATAGEN_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "position.hpp"
+#include "types.hpp"
+
+//----------------------------------------------------------------------
+// Training data
+//
+// Self-play games at a fixed node count, each started from a few random
+// plies, produce (position, search score, game result) samples. Samples
+// are 32-byte records with no file header, so a data file is a flat array
+// that can be appended to, split or shuffled with plain byte tools, and
+// read back by mapping it.
+//----------------------------------------------------------------------
+
+namespace Datagen {
+
+struct PackedPosition {
+    U64 occupancy;          // bit sq set when square sq (a8 = 0) is occupied
+    uint8_t pieces[16];     // Piece of the n-th occupied square, ascending, in nibble n (low first)
+    int16_t score;          // search score in centipawns, White's point of view
+    int8_t result;          // game result for White: 1 win, 0 draw, -1 loss
+    uint8_t side_to_move;   // Color
+    uint8_t castling;
+    uint8_t enpassant;      // no_sq when none
+    uint8_t halfmove;       // fifty-move counter, saturated at 255
+    uint8_t reserved;
+};
+static_assert(sizeof(PackedPosition) == 32, "records are 32 bytes on disk");
+
+PackedPosition pack(const Position& position, int white_score, int white_result);
+
+// Rebuilds the position (move counter 1, moves not generated). False when
+// the record holds an invalid piece code.
+bool unpack(const PackedPosition& record, Position& position);
+
+// Read-only mapping of a data file
+class DataFile {
+public:
+    DataFile() = default;
+    ~DataFile() { close(); }
+
+    DataFile(const DataFile&) = delete;
+    DataFile& operator=(const DataFile&) = delete;
+
+    // False when the file cannot be mapped or is not a whole number of records
+    bool open(const std::string& path);
+    void close();
+
+    bool is_open() const { return records != nullptr; }
+    size_t size() const { return count; }
+    const PackedPosition& operator[](size_t index) const { return records[index]; }
+    const PackedPosition* begin() const { return records; }
+    const PackedPosition* end() const { return records + count; }
+
+private:
+    const PackedPosition* records = nullptr;
+    size_t count = 0;
+};
+
+}
+
+// lumin datagen --out <file> [--positions N] [--games N] [--nodes N]
+//               [--threads T] [--random-plies P] [--hash MB] [--seed S]
+// lumin datagen stats <file> [--show N]
+//
+// Plays self-play games on T threads, each with its own slice of one
+// transposition table, and appends the quiet positions of every finished
+// game to <file>. Progress and the final rate are reported in positions
+// per second. "stats" maps a data file and summarizes it. Returns the
+// process exit code.
+int datagen_main(const std::vector<std::string>& args);
+
+#endif // DATAGEN_HPP
@@ -0,0 +1,110 @@
+#include "epd.hpp"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+//----------------------------------------------------------------------
+// EpdFile
+//----------------------------------------------------------------------
+
+EpdFile::EpdFile(const std::string& path) {
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) return;
+
+    struct stat info;
+    if (fstat(fd, &info) == 0) {
+        open = true;
+        length = static_cast<size_t>(info.st_size);
+        if (length > 0) {
+            void* mapping = mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (mapping == MAP_FAILED) {
+                open = false;
+                length = 0;
+            } else {
+                data = static_cast<const char*>(mapping);
+                madvise(mapping, length, MADV_SEQUENTIAL);
+            }
+        }
+    }
+    // The mapping keeps the file referenced
+    ::close(fd);
+}
+
+EpdFile::~EpdFile() {
+    if (data) munmap(const_cast<char*>(data), length);
+}
+
+bool EpdFile::next(std::string_view& line, size_t& line_number) {
+    while (cursor < length) {
+        size_t start = cursor;
+        while (cursor < length && data[cursor] != '\n') ++cursor;
+        size_t end = cursor;
+        if (cursor < length) ++cursor;          // skip the newline
+        ++line_count;
+
+        if (end > start && data[end - 1] == '\r') --end;
+        std::string_view text(data + start, end - start);
+        size_t first = text.find_first_not_of(" \t");
+        if (first == std::string_view::npos || text[first] == '#') continue;
+
+        line = text.substr(first);
+        line_number = line_count;
+        return true;
+    }
+    return false;
+}
+
+//----------------------------------------------------------------------
+// Lines and operations
+//----------------------------------------------------------------------
+
+FenError parse_epd(std::string_view line, Position& position, std::string_view& operations) {
+    size_t consumed = 0;
+    FenError error = parse_fen(line, position, &consumed);
+    operations = error == FenError::None ? line.substr(consumed) : std::string_view();
+    return error;
+}
+
+std::string_view next_token(std::string_view& text) {
+    size_t start = text.find_first_not_of(" \t\r\n");
+    if (start == std::string_view::npos) {
+        text = std::string_view();
+        return text;
+    }
+    size_t end = text.find_first_of(" \t\r\n", start);
+    if (end == std::string_view::npos) end = text.size();
+    std::string_view token = text.substr(start, end - start);
+    text.remove_prefix(end);
+    return token;
+}
+
+bool epd_operation(std::string_view operations, std::string_view opcode, std::string_view& operands) {
+    while (!operations.empty()) {
+        // One operation runs up to the next ';' outside a quoted string
+        size_t end = 0;
+        bool quoted = false;
+        while (end < operations.size() && (quoted || operations[end] != ';')) {
+            if (operations[end] == '"') quoted = !quoted;
+            ++end;
+        }
+        std::string_view operation = operations.substr(0, end);
+        operations.remove_prefix(end < operations.size() ? end + 1 : end);
+
+        if (next_token(operation) == opcode) {
+            size_t first = operation.find_first_not_of(" \t");
+            size_t last = operation.find_last_not_of(" \t\r\n");
+            operands = first == std::string_view::npos
+                     ? std::string_view() : operation.substr(first, last - first + 1);
+            return true;
+        }
+    }
+    return false;
+}
+
+std::string_view unquote(std::string_view operand) {
+    if (operand.size() >= 2 && operand.front() == '"' && operand.back() == '"')
+        return operand.substr(1, operand.size() - 2);
+    return operand;
+}
@@ -0,0 +1,61 @@
+#ifndef EPD_HPP
+#define EPD_HPP
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include "position.hpp"
+
+//----------------------------------------------------------------------
+// EPD input
+//
+//   <placement> <side> <castling> <ep> [hmvc fmvn] op1 operands; op2 ...;
+//
+// EpdFile memory-maps a whole file and hands out its lines one at a time
+// as views into the mapping, so reading a suite costs no copies and no
+// allocations; each line is only parsed when the caller asks for it.
+// Views stay valid as long as the EpdFile lives.
+//----------------------------------------------------------------------
+
+class EpdFile {
+public:
+    explicit EpdFile(const std::string& path);
+    ~EpdFile();
+
+    EpdFile(const EpdFile&) = delete;
+    EpdFile& operator=(const EpdFile&) = delete;
+
+    bool is_open() const { return open; }
+    size_t size() const { return length; }
+
+    // Next line that is neither blank nor a '#' comment, with its 1-based
+    // line number. False at the end of the file. Not thread-safe: callers
+    // sharing one file serialize their calls.
+    bool next(std::string_view& line, size_t& line_number);
+
+    // Back to the first line
+    void rewind() { cursor = 0; line_count = 0; }
+
+private:
+    const char* data = nullptr;
+    size_t length = 0;
+    size_t cursor = 0;
+    size_t line_count = 0;
+    bool open = false;
+};
+
+// Parses the position of an EPD (or FEN) line; `operations` receives the
+// rest of the line
+FenError parse_epd(std::string_view line, Position& position, std::string_view& operations);
+
+// Operands of the first operation with the given opcode, e.g. "Qg6 Nf5"
+// for bm. False when the operation is absent.
+bool epd_operation(std::string_view operations, std::string_view opcode, std::string_view& operands);
+
+// Splits off the next whitespace separated token; empty when none is left
+std::string_view next_token(std::string_view& text);
+
+// Removes the quotes around a string operand (id "WAC.001")
+std::string_view unquote(std::string_view operand);
+
+#endif // EPD_HPP
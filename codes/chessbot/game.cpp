@@ -4,11 +4,15 @@
 #include <cstdlib>
 #include <ctime>
 #include <unordered_map>
+#include <chrono>
+#include <algorithm>
 #include "game.hpp"
 #include "attacks.hpp"
 #include "bitboard.hpp"
 #include "uci.hpp"
-#include "Evaluation/basiceval.hpp"
+#include "search.hpp"
+#include "tt.hpp"
+#include "book.hpp"
 #include "movedef.hpp"
 
 //----------------------------------------------------------------------
@@ -103,6 +107,63 @@ int Game::getWinner(const Position &position) {
     }
 }
 
+void Game::setTimeControl(int base_ms, int inc_ms) {
+    clock_ms[White] = clock_ms[Black] = base_ms;
+    increment_ms = inc_ms;
+}
+
+void Game::setPondering(bool enabled) {
+    ponder_enabled = enabled;
+}
+
+SearchLimits Game::botLimits() const {
+    SearchLimits limits;
+    limits.time[White] = clock_ms[White];
+    limits.time[Black] = clock_ms[Black];
+    limits.inc[White] = limits.inc[Black] = increment_ms;
+    return limits;
+}
+
+//----------------------------------------------------------------------
+// Pondering
+//
+// After the bot moves, the reply it expects (the TT move of the current
+// position) is played on a copy and searched in the background while the
+// human thinks. If the human plays that move the search is told about the
+// ponderhit and simply continues on the bot's clock; on a miss it is
+// stopped, and the real search starts with a warm TT.
+//----------------------------------------------------------------------
+
+void Game::startPondering() {
+    TTHit hit;
+    if (!tt.probe(currposition.hash_key, hit) || !hit.move) return;
+    if (std::find(currposition.move_list.begin(), currposition.move_list.end(), hit.move)
+        == currposition.move_list.end()) return;
+
+    ponder_move = hit.move;
+    ponder_result = 0;
+
+    SearchLimits limits = botLimits();
+    limits.ponder = true;
+    Position expected = makemove(ponder_move, currposition);
+
+    time_manager.clear_stop_request();
+    ponder_thread = std::thread([this, expected, limits]() {
+        SearchContext context;
+        context.tree = &mcts_tree;
+        set_search_context(context);
+        ponder_result = findbestmove(expected, limits, SearchOutput::Silent);
+    });
+}
+
+void Game::stopPondering() {
+    if (!ponder_thread.joinable()) return;
+    time_manager.request_stop();
+    ponder_thread.join();
+    time_manager.clear_stop_request();
+    ponder_move = 0;
+}
+
 //----------------------------------------------------------------------
 // Main game loop (CORRECTED)
 //----------------------------------------------------------------------
@@ -113,15 +174,22 @@ void Game::Startplaying(Color YourColor, bool bot_vs_bot) {
     GameEnded = false;
     Winner = -2; // undefined
 
-    // Threefold repetition tracking
-    std::unordered_map<std::string, int> rep_count;
+    // Searches of this game share one MCTS tree
+    const SearchContext outer_context = search_context;
+    SearchContext context = outer_context;
+    context.tree = &mcts_tree;
+    set_search_context(context);
+    mcts_tree.clear();
+
+    // Threefold repetition tracking, keyed on the Zobrist key: the FEN
+    // carries the move counters, which differ between repetitions
+    std::unordered_map<U64, int> rep_count;
     
     // Generate initial moves
     currposition.generate_moves();
     
     // Track initial position
-    std::string fen = currposition.get_fen();
-    rep_count[fen] = 1;
+    rep_count[currposition.hash_key] = 1;
 
     std::cout << "Game started! " << (bot_vs_bot ? "Bot vs Bot" : "Human vs Bot") << std::endl;
     
@@ -136,11 +204,24 @@ void Game::Startplaying(Color YourColor, bool bot_vs_bot) {
         }
         
         Move mv = 0;
+        Color mover = currposition.SideToMove;
+        auto move_start = std::chrono::steady_clock::now();
         
         // Get move (bot or human)
         if (bot_vs_bot || currposition.SideToMove == BotColor) {
-            std::cout << "Bot is thinking..." << std::endl;
-            mv = findbestmove(currposition);
+            if (ponder_thread.joinable()) {
+                // Ponderhit: the clock restarts now, the search keeps its depth
+                std::cout << "Ponder hit, bot continues its search..." << std::endl;
+                time_manager.ponderhit();
+                ponder_thread.join();
+                ponder_move = 0;
+                mv = ponder_result;
+            } else if ((mv = book.probe(currposition))) {
+                std::cout << "Bot plays from book" << std::endl;
+            } else {
+                std::cout << "Bot is thinking..." << std::endl;
+                mv = findbestmove(currposition, botLimits());
+            }
             if (mv != 0) {
                 std::cout << "Bot plays: " 
                          << square_to_coordinates[get_move_source(mv)]
@@ -158,6 +239,12 @@ void Game::Startplaying(Color YourColor, bool bot_vs_bot) {
                 std::cout << "Invalid move! Try again." << std::endl;
                 continue;
             }
+            if (ponder_thread.joinable() && mv != ponder_move) {
+                std::cout << "Ponder miss (expected "
+                          << square_to_coordinates[get_move_source(ponder_move)]
+                          << square_to_coordinates[get_move_target(ponder_move)] << ")" << std::endl;
+                stopPondering();
+            }
             add_move(mv, moves_played);
         }
         
@@ -168,14 +255,18 @@ void Game::Startplaying(Color YourColor, bool bot_vs_bot) {
             break;
         }
         
+        // Update the mover's clock
+        auto spent = std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::steady_clock::now() - move_start).count();
+        clock_ms[mover] += increment_ms - static_cast<int>(spent);
+        std::cout << "Clock: White " << clock_ms[White] / 1000.0 << "s, Black "
+                  << clock_ms[Black] / 1000.0 << "s" << std::endl;
+        
         // Make the move
         currposition = makemove(mv, currposition);
         
         // Check for threefold repetition
-        fen = currposition.get_fen();
-        rep_count[fen]++;
-        
-        if (rep_count[fen] >= 3) {
+        if (++rep_count[currposition.hash_key] >= 3) {
             std::cout << "Draw by threefold repetition!" << std::endl;
             GameEnded = true;
             Winner = -1;
@@ -184,7 +275,15 @@ void Game::Startplaying(Color YourColor, bool bot_vs_bot) {
         
         // Generate moves for next turn
         currposition.generate_moves();
+
+        // The bot just moved: think about its answer while the human does
+        if (ponder_enabled && !bot_vs_bot && mover == BotColor && !isGameEnded(currposition)) {
+            startPondering();
+        }
     }
+
+    stopPondering();
+    set_search_context(outer_context);
     
     // Print final result
     currposition.print();
@@ -4,7 +4,10 @@
 #include "position.hpp"
 #include "types.hpp"
 #include "movedef.hpp"
+#include "timeman.hpp"
+#include "mcts.hpp"
 #include <string>
+#include <thread>
 
 class Game {
 public:
@@ -14,12 +17,37 @@ public:
     int Winner;  // -1 = draw, 0 = White wins, 1 = Black wins, -2 = undefined
     Moves moves_played;
 
-    Game() : BotColor(Black), GameEnded(false), Winner(-2) {}
+    // Clock (ms) for each colour, fed to the bot's time manager
+    int clock_ms[2];
+    int increment_ms;
 
-    bool isDrawByInsufficientMaterial(const Position &position);
+    // Think on the human's time (human vs bot only)
+    bool ponder_enabled;
+
+    Game() : BotColor(Black), GameEnded(false), Winner(-2),
+             clock_ms{180000, 180000}, increment_ms(2000), ponder_enabled(true) {}
+
+    void setTimeControl(int base_ms, int inc_ms);
+    void setPondering(bool enabled);
+
+    static bool isDrawByInsufficientMaterial(const Position &position);
     bool isGameEnded(const Position &position);
     int getWinner(const Position &position);
     void Startplaying(Color YourColor, bool bot_vs_bot = false);
+
+private:
+    // Background search of the position after the expected human reply
+    std::thread ponder_thread;
+    Move ponder_move = 0;       // reply being pondered on
+    Move ponder_result = 0;     // bot's answer to it, valid once joined
+
+    // Used by both the bot's searches and the ponder thread (never at the
+    // same time), so MCTS keeps its subtree from one move to the next
+    Mcts::Tree mcts_tree;
+
+    SearchLimits botLimits() const;
+    void startPondering();
+    void stopPondering();
 };
 
 #endif // GAME_HPP
@@ -0,0 +1,76 @@
+"""Small client for `lumin serve`.
+
+    python3 lumin_client.py --socket /tmp/lumin.sock --depth 10 "<fen>" ["<fen>" ...]
+    python3 lumin_client.py --port 7878 --nodes 200000 --multipv 3 < positions.fen
+    python3 lumin_client.py --socket /tmp/lumin.sock --stats
+    python3 lumin_client.py --socket /tmp/lumin.sock --shutdown
+
+Every FEN (arguments, else one per line on stdin) is sent as one request on
+a single connection; the answers come back in completion order and are
+printed as they arrive, one JSON object per line.
+"""
+
+import argparse
+import json
+import socket
+import sys
+
+
+def connect(args):
+    if args.socket:
+        sock = socket.socket(socket.AF_UNIX, socket.SOCK_STREAM)
+        sock.connect(args.socket)
+    else:
+        sock = socket.create_connection(("127.0.0.1", args.port))
+    return sock
+
+
+def exchange(sock, requests):
+    """Sends all requests, then yields one decoded answer per request."""
+    sock.sendall("".join(json.dumps(r) + "\n" for r in requests).encode())
+    reader = sock.makefile("r", encoding="utf-8")
+    for _ in requests:
+        line = reader.readline()
+        if not line:
+            raise ConnectionError("server closed the connection")
+        yield json.loads(line)
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Query a running lumin serve")
+    where = parser.add_mutually_exclusive_group(required=True)
+    where.add_argument("--socket", help="Unix domain socket path")
+    where.add_argument("--port", type=int, help="TCP port on 127.0.0.1")
+    parser.add_argument("--depth", type=int, default=0)
+    parser.add_argument("--nodes", type=int, default=0)
+    parser.add_argument("--movetime", type=int, default=0, help="milliseconds")
+    parser.add_argument("--multipv", type=int, default=1)
+    parser.add_argument("--stats", action="store_true", help="print the server counters")
+    parser.add_argument("--shutdown", action="store_true", help="stop the server")
+    parser.add_argument("fens", nargs="*")
+    args = parser.parse_args()
+
+    if args.stats or args.shutdown:
+        requests = [{"cmd": "stats" if args.stats else "shutdown"}]
+    else:
+        fens = args.fens or [line.strip() for line in sys.stdin if line.strip()]
+        if not (args.depth or args.nodes or args.movetime):
+            args.depth = 10
+        requests = [{"id": i, "fen": fen, "depth": args.depth, "nodes": args.nodes,
+                     "movetime": args.movetime, "multipv": args.multipv}
+                    for i, fen in enumerate(fens)]
+
+    failed = False
+    try:
+        with connect(args) as sock:
+            for answer in exchange(sock, requests):
+                print(json.dumps(answer), flush=True)
+                failed = failed or "error" in answer
+    except OSError as error:
+        print(f"lumin_client: {error}", file=sys.stderr)
+        return 1
+    return 1 if failed else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
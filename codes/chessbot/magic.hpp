@@ -119,7 +119,7 @@ inline U64 sliding_attacks_bishop(int square, U64 block) {
 
 // Precompute magic tables with debug printing
 inline void init_sliders() {
-    std::cout << "Initializing magic sliders...\n";
+    std::cerr << "Initializing magic sliders...\n";
     for (int sq = 0; sq < 64; ++sq) {
         U64 mask = rook_mask(sq);
         int bits = RookRelevantBits[sq];
@@ -0,0 +1,449 @@
+#include <iostream>
+#include <iomanip>
+#include <fstream>
+#include <sstream>
+#include <chrono>
+#include <cmath>
+#include <mutex>
+#include <thread>
+#include <atomic>
+#include <memory>
+#include <algorithm>
+
+#include "match.hpp"
+#include "epd.hpp"
+#include "position.hpp"
+#include "attacks.hpp"
+#include "search.hpp"
+#include "game.hpp"
+#include "bench.hpp"
+#include "tt.hpp"
+#include "uci.hpp"
+
+//----------------------------------------------------------------------
+// Configuration
+//----------------------------------------------------------------------
+
+struct EngineConfig {
+    std::string name;
+    EvaluatorType evaluator = EvaluatorType::Basic;
+    SearchLimits limits;          // per move: depth / nodes / movetime
+    int base_ms = 0;              // clock, when playing with a time control
+    int inc_ms = 0;
+    int hash_mb = 16;
+};
+
+struct Adjudication {
+    int resign_moves = 3;         // consecutive moves of both sides beyond resign_cp
+    int resign_cp = 700;
+    int draw_movenumber = 40;     // draw adjudication starts at this move number
+    int draw_moves = 8;           // consecutive moves of both sides within draw_cp
+    int draw_cp = 10;
+    int max_plies = 400;          // longer games are drawn
+};
+
+struct SprtConfig {
+    double elo0 = 0.0;
+    double elo1 = 5.0;
+    double alpha = 0.05;
+    double beta = 0.05;
+};
+
+static bool parse_engine_spec(const std::string& spec, EngineConfig& config) {
+    std::istringstream in(spec);
+    std::string item;
+    while (std::getline(in, item, ',')) {
+        size_t eq = item.find('=');
+        if (eq == std::string::npos) return false;
+        std::string key = item.substr(0, eq), value = item.substr(eq + 1);
+        if (key == "name") {
+            config.name = value;
+        } else if (key == "eval") {
+            if (!parse_evaluator(value, config.evaluator)) return false;
+        } else if (key == "depth") {
+            config.limits.depth = std::atoi(value.c_str());
+        } else if (key == "nodes") {
+            config.limits.nodes = std::strtoull(value.c_str(), nullptr, 10);
+        } else if (key == "movetime") {
+            config.limits.movetime = std::atoi(value.c_str());
+        } else if (key == "tc") {
+            size_t plus = value.find('+');
+            config.base_ms = static_cast<int>(std::atof(value.substr(0, plus).c_str()) * 1000);
+            config.inc_ms = plus == std::string::npos
+                          ? 0 : static_cast<int>(std::atof(value.substr(plus + 1).c_str()) * 1000);
+            if (config.base_ms <= 0) return false;
+        } else if (key == "hash") {
+            config.hash_mb = std::max(1, std::atoi(value.c_str()));
+        } else {
+            return false;
+        }
+    }
+    bool limited = config.limits.depth > 0 || config.limits.nodes > 0
+                || config.limits.movetime > 0 || config.base_ms > 0;
+    if (config.name.empty()) config.name = spec;
+    return limited;
+}
+
+// FEN or EPD lines; EPD operations are ignored
+static bool load_openings(const std::string& path, std::vector<std::string>& openings) {
+    EpdFile file(path);
+    if (!file.is_open()) return false;
+    Position position;
+    std::string_view line, operations;
+    size_t line_number = 0;
+    while (file.next(line, line_number)) {
+        FenError error = parse_epd(line, position, operations);
+        if (error != FenError::None) {
+            std::cerr << path << ":" << line_number << ": " << fen_error_string(error) << "\n";
+            continue;
+        }
+        openings.push_back(position.get_fen());
+    }
+    return true;
+}
+
+//----------------------------------------------------------------------
+// Statistics
+//
+// Scores are from engine1's point of view. The SPRT is the generalized
+// SPRT on the trinomial (win / draw / loss) model with logistic Elo: the
+// log-likelihood ratio of elo1 against elo0 is approximated from the
+// observed score mean and variance.
+//----------------------------------------------------------------------
+
+struct MatchScore {
+    int wins = 0, losses = 0, draws = 0;
+
+    int games() const { return wins + losses + draws; }
+    double mean() const { return games() ? (wins + 0.5 * draws) / games() : 0.5; }
+    double variance() const {
+        if (!games()) return 0.0;
+        double m = mean();
+        return (wins + 0.25 * draws) / games() - m * m;
+    }
+};
+
+static double score_from_elo(double elo) {
+    return 1.0 / (1.0 + std::pow(10.0, -elo / 400.0));
+}
+
+static double elo_from_score(double score) {
+    score = std::clamp(score, 1e-6, 1.0 - 1e-6);
+    return -400.0 * std::log10(1.0 / score - 1.0);
+}
+
+// Elo and half the width of its 95% confidence interval
+static std::pair<double, double> elo_estimate(const MatchScore& s) {
+    double m = s.mean();
+    if (s.games() == 0) return {0.0, 0.0};
+    double margin = 1.96 * std::sqrt(s.variance() / s.games());
+    double elo = elo_from_score(m);
+    return {elo, (elo_from_score(m + margin) - elo_from_score(m - margin)) / 2.0};
+}
+
+static double sprt_llr(const MatchScore& s, const SprtConfig& sprt) {
+    double var = s.variance();
+    if (s.games() == 0 || var <= 0.0) return 0.0;
+    double s0 = score_from_elo(sprt.elo0), s1 = score_from_elo(sprt.elo1);
+    return (s1 - s0) * (2.0 * s.mean() - s0 - s1) * s.games() / (2.0 * var);
+}
+
+//----------------------------------------------------------------------
+// One game
+//----------------------------------------------------------------------
+
+struct GameResult {
+    double white_score = 0.5;     // 1, 0.5 or 0
+    std::string reason;
+    std::vector<Move> moves;
+};
+
+class MatchWorker {
+public:
+    MatchWorker(const EngineConfig* configs, const Adjudication& adjudication)
+        : configs(configs), adjudication(adjudication), stats(std::make_unique<SearchStats::Group>()) {
+        for (int e = 0; e < 2; ++e) tables[e] = std::make_unique<TranspositionTable>(configs[e].hash_mb);
+    }
+
+    GameResult play(const std::string& fen, int white_engine);
+
+private:
+    const EngineConfig* configs;
+    const Adjudication& adjudication;
+    std::unique_ptr<TranspositionTable> tables[2];
+    TimeManager timer;
+    std::unique_ptr<SearchStats::Group> stats;
+};
+
+static bool in_check(const Position& position) {
+    U64 king = position.bitboards[position.SideToMove == White ? wK : bK];
+    return king && isSquareAttacked(get_ls1b_index(king), position, position.SideToMove == White ? Black : White);
+}
+
+// Occurrences of the current position since the last irreversible move
+static int repetitions(const std::vector<U64>& history, int fifty) {
+    int count = 0;
+    int last = static_cast<int>(history.size()) - 1;
+    for (int i = last; i >= 0 && last - i <= fifty; i -= 2) count += history[i] == history[last];
+    return count;
+}
+
+GameResult MatchWorker::play(const std::string& fen, int white_engine) {
+    GameResult result;
+    Position position = parsefen(fen);
+    position.generate_moves();
+
+    std::vector<U64> history{position.hash_key};
+    int clock_ms[2] = {configs[0].base_ms, configs[1].base_ms};   // by engine
+    int winning[2] = {0, 0}, losing[2] = {0, 0};                  // by engine, for resign adjudication
+    int drawish = 0;                                               // consecutive plies near 0
+
+    for (TranspositionTable* table : {tables[0].get(), tables[1].get()}) table->clear();
+
+    auto finish = [&](double white_score, const char* reason) {
+        result.white_score = white_score;
+        result.reason = reason;
+        return result;
+    };
+
+    for (int ply = 0; ; ++ply) {
+        Color us = position.SideToMove;
+        double win_for_us = us == White ? 1.0 : 0.0;
+
+        if (position.move_list.empty())
+            return in_check(position) ? finish(1.0 - win_for_us, "checkmate") : finish(0.5, "stalemate");
+        if (Game::isDrawByInsufficientMaterial(position)) return finish(0.5, "insufficient material");
+        if (position.FiftyMove) return finish(0.5, "fifty-move rule");
+        if (repetitions(history, position.halfmove) >= 3) return finish(0.5, "threefold repetition");
+        if (ply >= adjudication.max_plies) return finish(0.5, "adjudication: ply limit");
+
+        int engine = (us == White) == (white_engine == 0) ? 0 : 1;
+        const EngineConfig& config = configs[engine];
+
+        SearchLimits limits = config.limits;
+        if (config.base_ms > 0) {
+            limits.time[us] = clock_ms[engine];
+            limits.inc[us] = config.inc_ms;
+        }
+
+        set_search_context(SearchContext{tables[engine].get(), &timer, stats.get()});
+        std::vector<PVLine> lines;
+        auto t0 = std::chrono::steady_clock::now();
+        Move mv = findbestmove(config.evaluator, position, limits, SearchOutput::Silent, &lines);
+        int spent = static_cast<int>(std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::steady_clock::now() - t0).count());
+
+        if (!mv) return finish(1.0 - win_for_us, "no move returned");
+        if (config.base_ms > 0) {
+            clock_ms[engine] -= spent;
+            if (clock_ms[engine] < 0) return finish(1.0 - win_for_us, "time forfeit");
+            clock_ms[engine] += config.inc_ms;
+        }
+        result.moves.push_back(mv);
+
+        // Score adjudication, on the mover's own evaluation
+        if (!lines.empty()) {
+            int score = lines.front().score;
+            winning[engine] = score >= adjudication.resign_cp ? winning[engine] + 1 : 0;
+            losing[engine] = score <= -adjudication.resign_cp ? losing[engine] + 1 : 0;
+            drawish = std::abs(score) <= adjudication.draw_cp ? drawish + 1 : 0;
+        }
+
+        // Resign: the mover has been lost for a while and the opponent agrees
+        if (losing[engine] >= adjudication.resign_moves && winning[1 - engine] >= adjudication.resign_moves)
+            return finish(1.0 - win_for_us, "adjudication: resign");
+        if (winning[engine] >= adjudication.resign_moves && losing[1 - engine] >= adjudication.resign_moves)
+            return finish(win_for_us, "adjudication: resign");
+        if (position.fullmove >= adjudication.draw_movenumber && drawish >= 2 * adjudication.draw_moves)
+            return finish(0.5, "adjudication: draw");
+
+        position = makemove(mv, position);
+        position.generate_moves();
+        history.push_back(position.hash_key);
+    }
+}
+
+//----------------------------------------------------------------------
+// Match
+//----------------------------------------------------------------------
+
+static std::string result_string(double white_score) {
+    return white_score == 1.0 ? "1-0" : white_score == 0.0 ? "0-1" : "1/2-1/2";
+}
+
+static std::string to_pgn(const std::string& fen, const GameResult& game, const std::string& white,
+                          const std::string& black, size_t round) {
+    std::ostringstream out;
+    std::string result = result_string(game.white_score);
+    out << "[Event \"Lumin match\"]\n"
+        << "[Round \"" << round << "\"]\n"
+        << "[White \"" << white << "\"]\n"
+        << "[Black \"" << black << "\"]\n"
+        << "[Result \"" << result << "\"]\n"
+        << "[SetUp \"1\"]\n"
+        << "[FEN \"" << fen << "\"]\n"
+        << "[PlyCount \"" << game.moves.size() << "\"]\n"
+        << "[Termination \"" << game.reason << "\"]\n\n";
+
+    Position position = parsefen(fen);
+    position.generate_moves();
+    int move_number = position.fullmove;
+    for (size_t i = 0; i < game.moves.size(); ++i) {
+        if (position.SideToMove == White) out << move_number << ". ";
+        else if (i == 0) out << move_number << "... ";
+        out << move_to_san(game.moves[i], position) << " ";
+        if (position.SideToMove == Black) ++move_number;
+        position = makemove(game.moves[i], position);
+        position.generate_moves();
+    }
+    out << result << "\n\n";
+    return out.str();
+}
+
+static void print_match_usage() {
+    std::cerr << "Usage: lumin match --engine1 <spec> --engine2 <spec> [--openings <file>] [--games N]\n"
+                 "                   [--concurrency J] [--sprt elo0 elo1 alpha beta] [--pgn <file>]\n"
+                 "                   [--resign moves cp] [--draw movenumber moves cp] [--maxplies N]\n"
+                 "  spec: name=X,eval=basic|pesto,depth=D,nodes=N,movetime=MS,tc=S+INC,hash=MB\n";
+}
+
+int match_main(const std::vector<std::string>& args) {
+    EngineConfig configs[2];
+    bool have_config[2] = {false, false};
+    Adjudication adjudication;
+    SprtConfig sprt;
+    std::string openings_path, pgn_path;
+    int max_games = 0;
+    int concurrency = std::max(1u, std::thread::hardware_concurrency());
+
+    auto need = [&](size_t i, size_t count) { return i + count < args.size(); };
+    for (size_t i = 0; i < args.size(); ++i) {
+        const std::string& arg = args[i];
+        if ((arg == "--engine1" || arg == "--engine2") && need(i, 1)) {
+            int e = arg == "--engine1" ? 0 : 1;
+            have_config[e] = parse_engine_spec(args[++i], configs[e]);
+            if (!have_config[e]) {
+                std::cerr << "Invalid engine spec: " << args[i] << "\n";
+                return 1;
+            }
+        } else if (arg == "--openings" && need(i, 1)) {
+            openings_path = args[++i];
+        } else if (arg == "--pgn" && need(i, 1)) {
+            pgn_path = args[++i];
+        } else if (arg == "--games" && need(i, 1)) {
+            max_games = std::atoi(args[++i].c_str());
+        } else if (arg == "--concurrency" && need(i, 1)) {
+            concurrency = std::atoi(args[++i].c_str());
+        } else if (arg == "--maxplies" && need(i, 1)) {
+            adjudication.max_plies = std::atoi(args[++i].c_str());
+        } else if (arg == "--sprt" && need(i, 4)) {
+            sprt.elo0 = std::atof(args[++i].c_str());
+            sprt.elo1 = std::atof(args[++i].c_str());
+            sprt.alpha = std::atof(args[++i].c_str());
+            sprt.beta = std::atof(args[++i].c_str());
+        } else if (arg == "--resign" && need(i, 2)) {
+            adjudication.resign_moves = std::atoi(args[++i].c_str());
+            adjudication.resign_cp = std::atoi(args[++i].c_str());
+        } else if (arg == "--draw" && need(i, 3)) {
+            adjudication.draw_movenumber = std::atoi(args[++i].c_str());
+            adjudication.draw_moves = std::atoi(args[++i].c_str());
+            adjudication.draw_cp = std::atoi(args[++i].c_str());
+        } else {
+            print_match_usage();
+            return 1;
+        }
+    }
+    if (!have_config[0] || !have_config[1] || sprt.alpha <= 0 || sprt.beta <= 0 || sprt.elo1 <= sprt.elo0) {
+        print_match_usage();
+        return 1;
+    }
+
+    std::vector<std::string> openings;
+    if (openings_path.empty()) {
+        openings = bench_positions();
+    } else if (!load_openings(openings_path, openings) || openings.empty()) {
+        std::cerr << "Cannot read openings from " << openings_path << "\n";
+        return 1;
+    }
+    if (max_games <= 0) max_games = static_cast<int>(2 * openings.size());
+    concurrency = std::clamp(concurrency, 1, std::min(max_games, SearchStats::MAX_THREADS));
+
+    std::ofstream pgn;
+    if (!pgn_path.empty()) {
+        pgn.open(pgn_path);
+        if (!pgn) {
+            std::cerr << "Cannot write " << pgn_path << "\n";
+            return 1;
+        }
+    }
+
+    // Each game is one single-threaded search per move
+    search_threads = 1;
+    multi_pv = 1;
+
+    const double lower = std::log(sprt.beta / (1.0 - sprt.alpha));
+    const double upper = std::log((1.0 - sprt.beta) / sprt.alpha);
+    std::cout << configs[0].name << " vs " << configs[1].name << ": " << max_games << " games, "
+              << openings.size() << " openings, concurrency " << concurrency
+              << ", SPRT elo0 " << sprt.elo0 << " elo1 " << sprt.elo1
+              << " bounds [" << std::fixed << std::setprecision(2) << lower << ", " << upper << "]\n";
+
+    std::atomic<int> next_game{0};
+    std::atomic<bool> finished{false};
+    std::mutex result_lock;
+    MatchScore score;
+    std::string verdict;
+
+    // Game g plays opening g / 2, engine1 has White in even games
+    auto worker = [&]() {
+        MatchWorker games(configs, adjudication);
+        while (!finished.load()) {
+            int g = next_game.fetch_add(1);
+            if (g >= max_games) break;
+            const std::string& fen = openings[(g / 2) % openings.size()];
+            int white_engine = g % 2;
+            GameResult game = games.play(fen, white_engine);
+
+            double engine1 = white_engine == 0 ? game.white_score : 1.0 - game.white_score;
+            std::lock_guard<std::mutex> lk(result_lock);
+            if (engine1 == 1.0) ++score.wins;
+            else if (engine1 == 0.0) ++score.losses;
+            else ++score.draws;
+
+            auto [elo, margin] = elo_estimate(score);
+            double llr = sprt_llr(score, sprt);
+            std::cout << "Game " << std::setw(4) << g + 1 << ": "
+                      << configs[white_engine].name << " - " << configs[1 - white_engine].name << " "
+                      << result_string(game.white_score) << " (" << game.reason << ", "
+                      << game.moves.size() << " plies) | "
+                      << "W " << score.wins << " L " << score.losses << " D " << score.draws
+                      << " | Elo " << std::setprecision(1) << elo << " +/- " << margin
+                      << " | LLR " << std::setprecision(2) << llr << std::endl;
+            if (pgn.is_open())
+                pgn << to_pgn(fen, game, configs[white_engine].name, configs[1 - white_engine].name, g + 1)
+                    << std::flush;
+
+            if (verdict.empty() && (llr >= upper || llr <= lower)) {
+                verdict = llr >= upper ? "H1 accepted" : "H0 accepted";
+                finished.store(true);
+            }
+        }
+    };
+
+    auto t0 = std::chrono::steady_clock::now();
+    std::vector<std::thread> workers;
+    for (int j = 0; j < concurrency; ++j) workers.emplace_back(worker);
+    for (std::thread& t : workers) t.join();
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+
+    auto [elo, margin] = elo_estimate(score);
+    std::cout << "\nFinished " << score.games() << " games in " << std::setprecision(1) << seconds << " s\n"
+              << configs[0].name << " vs " << configs[1].name << ": "
+              << "W " << score.wins << " L " << score.losses << " D " << score.draws
+              << ", score " << std::setprecision(3) << score.mean()
+              << ", Elo " << std::setprecision(1) << elo << " +/- " << margin << "\n"
+              << "SPRT: LLR " << std::setprecision(2) << sprt_llr(score, sprt)
+              << " [" << lower << ", " << upper << "], "
+              << (verdict.empty() ? "inconclusive" : verdict) << "\n";
+    return 0;
+}
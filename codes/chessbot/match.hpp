@@ -0,0 +1,26 @@
+#ifndef MATCH_HPP
+#define MATCH_HPP
+
+#include <string>
+#include <vector>
+
+// lumin match --engine1 <spec> --engine2 <spec> [--openings <file>] [--games N]
+//             [--concurrency J] [--sprt elo0 elo1 alpha beta] [--pgn <file>]
+//             [--resign moves cp] [--draw movenumber moves cp] [--maxplies N]
+//
+// Headless self-play between two engine configurations. An engine spec is
+// a comma separated list of key=value pairs:
+//
+//   name=new,eval=pesto,depth=6,nodes=20000,movetime=100,tc=10+0.1,hash=16
+//
+// (depth / nodes / movetime limit every move, tc plays on a clock that can
+// be lost on time). Every opening (one FEN or EPD per line, the bench
+// positions by default) is played twice with colours swapped, J games at a
+// time, each worker with its own transposition tables. Games end on mate,
+// stalemate, repetition, the fifty-move rule, insufficient material, the
+// ply limit or score adjudication. After each game the result, the Elo of
+// engine1 and the SPRT log-likelihood ratio are printed; the match stops as
+// soon as the SPRT accepts either hypothesis. Returns the process exit code.
+int match_main(const std::vector<std::string>& args);
+
+#endif // MATCH_HPP
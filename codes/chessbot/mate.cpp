@@ -0,0 +1,277 @@
+#include "mate.hpp"
+#include "attacks.hpp"
+#include "bitboard.hpp"
+#include "search.hpp"
+#include "stats.hpp"
+#include "uci.hpp"
+
+#include <algorithm>
+#include <cstdlib>
+#include <iostream>
+
+namespace {
+
+// Proof and disproof numbers saturate here: a node with pn == 0 (and
+// dn == INF) is proven, one with dn == 0 (and pn == INF) disproven
+constexpr uint32_t INF = 1u << 30;
+
+inline uint32_t saturate(uint64_t value) {
+    return static_cast<uint32_t>(std::min<uint64_t>(value, INF));
+}
+
+// The same position with more moves left is a different problem
+inline U64 node_key(const Position& pos, int moves_left) {
+    return pos.hash_key ^ (static_cast<U64>(moves_left + 1) * 0x9E3779B97F4A7C15ULL);
+}
+
+bool in_check(const Position& pos) {
+    int king = get_ls1b_index(pos.bitboards[pos.SideToMove == White ? wK : bK]);
+    return isSquareAttacked(king, pos, pos.SideToMove ^ 1);
+}
+
+} // namespace
+
+MateSolver::MateSolver(size_t mb) {
+    size_t entries = 1;
+    while (entries * 2 * sizeof(Entry) <= std::max<size_t>(mb, 1) * 1024 * 1024) entries *= 2;
+    table.assign(entries, Entry{0, 0, 0});
+    mask = entries - 1;
+}
+
+void MateSolver::lookup(U64 key, uint32_t& pn, uint32_t& dn) const {
+    const Entry& entry = table[key & mask];
+    if (entry.key == key) {
+        pn = entry.pn;
+        dn = entry.dn;
+    } else {
+        pn = dn = 1;
+    }
+}
+
+void MateSolver::store(U64 key, uint32_t pn, uint32_t dn) {
+    table[key & mask] = Entry{key, pn, dn};
+}
+
+// Multiple iterative deepening: expand the most proving child until the
+// node's numbers reach one of its thresholds, then hand control back
+void MateSolver::mid(const Position& pos, int moves_left, uint32_t th_pn, uint32_t th_dn) {
+    SearchStats::count_node();
+    if (timer->poll()) return;
+
+    const bool or_node = pos.SideToMove == attacker;
+    const U64 key = node_key(pos, moves_left);
+
+    Position node = pos;
+    node.generate_moves();
+    if (node.move_list.empty()) {
+        // Only a mated defender proves; stalemate and a mated attacker disprove
+        if (!or_node && in_check(node)) store(key, 0, INF);
+        else                             store(key, INF, 0);
+        return;
+    }
+    if (moves_left == 0) {
+        store(key, INF, 0);
+        return;
+    }
+
+    const int child_left = or_node ? moves_left - 1 : moves_left;
+    std::vector<Position> children;
+    std::vector<U64> keys;
+    children.reserve(node.move_list.size());
+    keys.reserve(node.move_list.size());
+    for (Move m : node.move_list) {
+        children.push_back(makemove(m, node));
+        keys.push_back(node_key(children.back(), child_left));
+    }
+
+    for (;;) {
+        // OR: pn = min, dn = sum over children; AND the other way round
+        uint64_t sum = 0;
+        uint32_t best = INF + 1, second = INF + 1, best_pn = 1, best_dn = 1;
+        size_t best_index = 0;
+        for (size_t i = 0; i < children.size(); ++i) {
+            uint32_t pn, dn;
+            lookup(keys[i], pn, dn);
+            uint32_t minimized = or_node ? pn : dn;
+            sum += or_node ? dn : pn;
+            if (minimized < best) {
+                second = best;
+                best = minimized;
+                best_index = i;
+                best_pn = pn;
+                best_dn = dn;
+            } else if (minimized < second) {
+                second = minimized;
+            }
+        }
+
+        uint32_t pn = or_node ? best : saturate(sum);
+        uint32_t dn = or_node ? saturate(sum) : best;
+        if (pn >= th_pn || dn >= th_dn) {
+            store(key, pn, dn);
+            return;
+        }
+
+        uint32_t child_pn, child_dn;
+        if (or_node) {
+            child_pn = static_cast<uint32_t>(std::min<uint64_t>(th_pn, uint64_t(second) + 1));
+            child_dn = saturate(uint64_t(th_dn) - dn + best_dn);
+        } else {
+            child_dn = static_cast<uint32_t>(std::min<uint64_t>(th_dn, uint64_t(second) + 1));
+            child_pn = saturate(uint64_t(th_pn) - pn + best_pn);
+        }
+        mid(children[best_index], child_left, child_pn, child_dn);
+        if (timer->stopped()) return;
+    }
+}
+
+// Fewest moves left, up to max_left, at which the table holds a proof
+// for the node; -1 when it holds none
+int MateSolver::proven_moves(const Position& pos, int max_left) const {
+    for (int moves = 0; moves <= max_left; ++moves) {
+        uint32_t pn, dn;
+        lookup(node_key(pos, moves), pn, dn);
+        if (pn == 0) return moves;
+    }
+    return -1;
+}
+
+// Read from the proof table without searching, so the line is complete
+// even when the proof used up the time: attacker moves into the quickest
+// proven child, defender replies into the slowest. Stops early only if a
+// proof entry was overwritten.
+std::vector<Move> MateSolver::principal_variation(Position pos, int moves) {
+    std::vector<Move> pv;
+    while (moves > 0) {
+        pos.generate_moves();
+        Move mating = 0;
+        int fastest = moves;
+        Position after;
+        for (Move m : pos.move_list) {
+            Position next = makemove(m, pos);
+            int left = proven_moves(next, moves - 1);
+            if (left >= 0 && left < fastest) {
+                fastest = left;
+                mating = m;
+                after = next;
+            }
+        }
+        if (!mating) break;
+        pv.push_back(mating);
+        pos = after;
+        moves = fastest;
+
+        pos.generate_moves();
+        if (pos.move_list.empty()) break;
+        Move reply = 0;
+        int longest = 0;
+        for (Move m : pos.move_list) {
+            Position next = makemove(m, pos);
+            int left = proven_moves(next, moves);
+            if (left > longest) {
+                longest = left;
+                reply = m;
+                after = next;
+            }
+        }
+        if (!reply) break;
+        pv.push_back(reply);
+        pos = after;
+        moves = longest;
+    }
+    return pv;
+}
+
+MateResult MateSolver::solve(const Position& root, int max_moves, TimeManager& manager, const Report& report) {
+    MateResult result;
+    std::fill(table.begin(), table.end(), Entry{0, 0, 0});
+    attacker = root.SideToMove;
+    timer = &manager;
+
+    int moves = 1;
+    for (; moves <= max_moves; ++moves) {
+        mid(root, moves, INF, INF);
+        if (timer->stopped()) break;
+
+        uint32_t pn, dn;
+        lookup(node_key(root, moves), pn, dn);
+        if (pn == 0) {
+            result.moves = moves;
+            result.pv = principal_variation(root, moves);
+            if (report) report(moves, result);
+            return result;
+        }
+        if (report) report(moves, result);
+    }
+    result.disproved = moves > max_moves;
+    return result;
+}
+
+//----------------------------------------------------------------------
+// lumin mate
+//----------------------------------------------------------------------
+
+static void print_mate_usage() {
+    std::cerr << "Usage: lumin mate <fen> <max_moves> [--nodes N] [--movetime MS] [--hash MB]\n";
+}
+
+int mate_main(const std::vector<std::string>& args) {
+    std::vector<std::string> words;
+    SearchLimits limits;
+    int hash_mb = static_cast<int>(MateSolver::DEFAULT_MB);
+
+    for (size_t i = 0; i < args.size(); ++i) {
+        const std::string& arg = args[i];
+        bool has_value = i + 1 < args.size();
+        if      (arg == "--nodes" && has_value)    limits.nodes = std::strtoull(args[++i].c_str(), nullptr, 10);
+        else if (arg == "--movetime" && has_value) limits.movetime = std::atoi(args[++i].c_str());
+        else if (arg == "--hash" && has_value)     hash_mb = std::atoi(args[++i].c_str());
+        else if (arg.rfind("--", 0) == 0) {
+            print_mate_usage();
+            return 1;
+        } else {
+            words.push_back(arg);
+        }
+    }
+
+    int max_moves = words.size() >= 2 ? std::atoi(words.back().c_str()) : 0;
+    if (max_moves <= 0) {
+        print_mate_usage();
+        return 1;
+    }
+    std::string fen;
+    for (size_t i = 0; i + 1 < words.size(); ++i) fen += (i ? " " : "") + words[i];
+
+    Position position;
+    FenError error = parse_fen(fen, position);
+    if (error != FenError::None) {
+        std::cerr << "Invalid FEN (" << fen_error_string(error) << ")\n";
+        return 1;
+    }
+
+    MateSolver solver(static_cast<size_t>(std::max(1, hash_mb)));
+    SearchStats::bind_thread(0);
+    SearchStats::reset_counters();
+    time_manager.start(limits, position.SideToMove);
+    MateResult result = solver.solve(position, max_moves, time_manager);
+    SearchStats::finish();
+
+    uint64_t nodes = SearchStats::get_positions_searched();
+    double ms = SearchStats::get_search_time_ms();
+    if (result.moves) {
+        std::cout << "Mate in " << result.moves << ":";
+        Position line = position;
+        for (Move m : result.pv) {
+            std::cout << ' ' << move_to_san(m, line);
+            line = makemove(m, line);
+        }
+        std::cout << "\n";
+    } else if (result.disproved) {
+        std::cout << "No mate in " << max_moves << "\n";
+    } else {
+        std::cout << "No mate found before the limit\n";
+    }
+    std::cout << "Nodes: " << nodes << ", time: " << static_cast<int64_t>(ms) << " ms, nps: "
+              << static_cast<uint64_t>(ms > 0 ? nodes * 1000.0 / ms : nodes) << "\n";
+    return result.moves ? 0 : 1;
+}
@@ -0,0 +1,72 @@
+#ifndef MATE_HPP
+#define MATE_HPP
+
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+#include "position.hpp"
+#include "movedef.hpp"
+#include "timeman.hpp"
+#include "types.hpp"
+
+//----------------------------------------------------------------------
+// Mate solver
+//
+// Depth-first proof-number search (df-pn) for "side to move mates in at
+// most N moves". Attacker nodes are OR nodes (one mating move proves
+// them), defender nodes AND nodes (every reply must be mated). Each node
+// carries a proof and a disproof number, the number of leaves still to
+// settle either way, and the search always expands the most proving
+// child under thresholds passed down from its parent, so narrow forcing
+// lines are followed deep while wide quiet trees cost little. Results live
+// in the solver's own table, keyed by position and moves left.
+//----------------------------------------------------------------------
+
+struct MateResult {
+    int moves = 0;              // length of the shortest mate, 0 when none was found
+    bool disproved = false;     // no mate in max_moves at all (vs. stopped early)
+    std::vector<Move> pv;       // mating line, attacker and defender moves
+};
+
+class MateSolver {
+public:
+    static constexpr size_t DEFAULT_MB = 64;
+
+    explicit MateSolver(size_t mb = DEFAULT_MB);
+
+    // Tries 1, 2, ... max_moves moves so the first proof is the shortest
+    // mate. The search polls `timer` (already started by the caller) and
+    // counts its nodes in the calling thread's SearchStats slot. `report`,
+    // when given, is called after every proof and disproof with the moves
+    // tried so far.
+    using Report = std::function<void(int moves, const MateResult& result)>;
+    MateResult solve(const Position& root, int max_moves, TimeManager& timer, const Report& report = nullptr);
+
+private:
+    struct Entry {
+        U64 key;
+        uint32_t pn;
+        uint32_t dn;
+    };
+
+    void lookup(U64 key, uint32_t& pn, uint32_t& dn) const;
+    void store(U64 key, uint32_t pn, uint32_t dn);
+
+    void mid(const Position& pos, int moves_left, uint32_t th_pn, uint32_t th_dn);
+    int  proven_moves(const Position& pos, int max_left) const;
+    std::vector<Move> principal_variation(Position pos, int moves);
+
+    std::vector<Entry> table;
+    U64 mask = 0;
+    Color attacker = White;
+    TimeManager* timer = nullptr;
+};
+
+// lumin mate <fen> <max_moves> [--nodes N] [--movetime MS] [--hash MB]
+//
+// Looks for the shortest forced mate by the side to move and prints it
+// with its node count and time. Returns 0 when a mate was found.
+int mate_main(const std::vector<std::string>& args);
+
+#endif // MATE_HPP
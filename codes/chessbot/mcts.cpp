@@ -0,0 +1,501 @@
+#include "mcts.hpp"
+#include "attacks.hpp"
+#include "bitboard.hpp"
+#include "stats.hpp"
+#include "uci.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <iostream>
+#include <thread>
+
+namespace Mcts {
+
+namespace {
+
+constexpr int64_t SCALE = 1 << 16;      // fixed point of node values in [-1, 1]
+constexpr float C_PUCT = 1.5f;          // exploration weight of the prior
+constexpr float FPU_REDUCTION = 0.2f;   // unvisited children start below their parent
+constexpr int BATCH_SIZE = 8;           // leaves evaluated per call
+constexpr int MAX_PLY = 128;
+constexpr double EVAL_SCALE = 300.0;    // centipawns for atanh(value) = 1
+constexpr int64_t REPORT_MS = 1000;
+
+thread_local std::unique_ptr<Tree> thread_tree;
+
+// The context's tree, else one per thread that lives as long as it
+Tree& current_tree() {
+    if (search_context.tree) return *search_context.tree;
+    if (!thread_tree) thread_tree = std::make_unique<Tree>();
+    return *thread_tree;
+}
+
+float mean_value(const Node& node) {
+    int32_t visits = node.visits.load(std::memory_order_relaxed);
+    return visits > 0
+        ? static_cast<float>(node.value.load(std::memory_order_relaxed)) / (static_cast<float>(visits) * SCALE)
+        : 0.0f;
+}
+
+int value_to_cp(float value) {
+    double q = std::clamp(static_cast<double>(value), -0.999, 0.999);
+    return static_cast<int>(EVAL_SCALE * std::atanh(q));
+}
+
+void init_node(Node& node, Move move, float prior) {
+    node.move = move;
+    node.prior = prior;
+    node.visits.store(0, std::memory_order_relaxed);
+    node.value.store(0, std::memory_order_relaxed);
+    node.first_child = 0;
+    node.child_count = 0;
+    node.result = 0;
+    node.state.store(Node::Unexpanded, std::memory_order_relaxed);
+}
+
+void copy_node(Node& from, Node& to) {
+    to.move = from.move;
+    to.prior = from.prior;
+    to.visits.store(from.visits.load(std::memory_order_relaxed), std::memory_order_relaxed);
+    to.value.store(from.value.load(std::memory_order_relaxed), std::memory_order_relaxed);
+    to.first_child = 0;
+    to.child_count = 0;
+    to.result = from.result;
+    uint8_t state = from.state.load(std::memory_order_relaxed);
+    to.state.store(state == Node::Terminal ? Node::Terminal : Node::Unexpanded, std::memory_order_relaxed);
+}
+
+// Prior logits: captures by what they win, queen promotions
+float move_logit(Move move) {
+    static const int values[6] = {1, 3, 3, 5, 9, 0};
+    float logit = 0.0f;
+    if (get_move_capture_flag(move)) {
+        logit += 2.0f + 0.5f * (values[get_move_captured(move) % 6] - values[get_move_piece(move) % 6] / 4.0f);
+    }
+    if (get_move_promoted(move) != get_move_piece(move)) {
+        logit += get_move_promoted(move) % 6 == wQ ? 3.0f : -1.0f;
+    }
+    return logit;
+}
+
+bool in_check(const Position& pos) {
+    int king = get_ls1b_index(pos.bitboards[pos.SideToMove == White ? wK : bK]);
+    return isSquareAttacked(king, pos, pos.SideToMove ^ 1);
+}
+
+// Leaf values in [-1, 1] for the side to move, a batch at a time. This is
+// where a value network would evaluate all positions in one call.
+template<typename Evaluator>
+void evaluate_batch(const Position* const* positions, int count, float* values) {
+    for (int i = 0; i < count; ++i) {
+        int cp = Quiescence<Evaluator>(*positions[i], -2 * MATE_SCORE, 2 * MATE_SCORE, 1);
+        values[i] = static_cast<float>(std::tanh(cp / EVAL_SCALE));
+    }
+}
+
+// One playout on its way down: the nodes visited and the leaf position
+struct Leaf {
+    uint32_t path[MAX_PLY + 1];
+    int length = 0;
+    Position position;
+    float value = 0.0f;
+};
+
+enum class Walk { Evaluate, Known, Collision, Full };
+
+template<typename Evaluator>
+class Searcher {
+public:
+    Searcher(Tree& tree, TimeManager& timer, uint64_t max_playouts)
+        : tree(tree), arena(tree.nodes()), timer(timer), max_playouts(max_playouts) {}
+
+    std::atomic<uint64_t> playouts{0};
+    std::atomic<int> seldepth{0};
+
+    void work(int thread_id, const SearchContext& context, const std::function<void()>& report) {
+        set_search_context(context);
+        SearchStats::bind_thread(thread_id);
+        std::vector<Leaf> batch(BATCH_SIZE);
+        const Position* positions[BATCH_SIZE];
+        float values[BATCH_SIZE];
+        int64_t last_report = 0;
+
+        while (!timer.stopped()) {
+            int count = 0;
+            for (int b = 0; b < BATCH_SIZE; ++b) {
+                Leaf& leaf = batch[count];
+                Walk walk = descend(leaf);
+                if (walk == Walk::Collision) break;
+                if (walk == Walk::Full) {
+                    timer.stop_now();
+                    break;
+                }
+                if (walk == Walk::Known) {
+                    backup(leaf, leaf.value);
+                    playouts.fetch_add(1, std::memory_order_relaxed);
+                    continue;
+                }
+                positions[count++] = &leaf.position;
+            }
+
+            evaluate_batch<Evaluator>(positions, count, values);
+            for (int i = 0; i < count; ++i) {
+                // A stopped quiescence search returns nothing worth keeping
+                if (timer.stopped()) revert(batch[i]);
+                else                 backup(batch[i], values[i]);
+            }
+            uint64_t done = playouts.fetch_add(count, std::memory_order_relaxed) + count;
+
+            if (timer.poll() || (max_playouts && done >= max_playouts)) timer.stop_now();
+            if (report && timer.elapsed_ms() - last_report >= REPORT_MS) {
+                last_report = timer.elapsed_ms();
+                report();
+            }
+        }
+    }
+
+private:
+    Tree& tree;
+    Arena& arena;
+    TimeManager& timer;
+    uint64_t max_playouts;
+
+    static void add_virtual_loss(Node& node) {
+        node.visits.fetch_add(1, std::memory_order_relaxed);
+        node.value.fetch_sub(SCALE, std::memory_order_relaxed);
+    }
+
+    // PUCT: mean value plus the prior scaled by how little the child was tried
+    uint32_t select_child(Node& node) {
+        int32_t parent_visits = node.visits.load(std::memory_order_relaxed);
+        float first_play = -mean_value(node) - FPU_REDUCTION;
+        float exploration = C_PUCT * std::sqrt(static_cast<float>(std::max(1, parent_visits)));
+
+        uint32_t best = node.first_child;
+        float best_score = -1e9f;
+        for (uint32_t i = node.first_child; i < node.first_child + node.child_count; ++i) {
+            Node& child = arena[i];
+            // A mating move needs no statistics
+            if (child.state.load(std::memory_order_relaxed) == Node::Terminal && child.result < 0) return i;
+            int32_t visits = child.visits.load(std::memory_order_relaxed);
+            float q = visits > 0 ? mean_value(child) : first_play;
+            float score = q + exploration * child.prior / (1.0f + visits);
+            if (score > best_score) {
+                best_score = score;
+                best = i;
+            }
+        }
+        return best;
+    }
+
+    // Generates the children with their priors; false when the arena is full
+    bool expand(Node& node, Position& pos) {
+        uint32_t block = arena.allocate(pos.move_list.size());
+        if (block == Arena::NONE) return false;
+
+        float logits[256], total = 0.0f, top = -1e9f;
+        size_t n = std::min<size_t>(pos.move_list.size(), 256);
+        for (size_t i = 0; i < n; ++i) top = std::max(top, logits[i] = move_logit(pos.move_list[i]));
+        for (size_t i = 0; i < n; ++i) total += (logits[i] = std::exp(logits[i] - top));
+        for (size_t i = 0; i < n; ++i) init_node(arena[block + i], pos.move_list[i], logits[i] / total);
+
+        node.first_child = block;
+        node.child_count = static_cast<uint16_t>(n);
+        return true;
+    }
+
+    Walk descend(Leaf& leaf) {
+        uint32_t index = 0;
+        leaf.length = 0;
+        leaf.position = tree.root_position();
+
+        for (;;) {
+            Node& node = arena[index];
+            add_virtual_loss(node);
+            leaf.path[leaf.length++] = index;
+
+            uint8_t state = node.state.load(std::memory_order_acquire);
+            if (state == Node::Terminal) {
+                leaf.value = node.result;
+                return Walk::Known;
+            }
+            if (state == Node::Expanding) {
+                revert(leaf);
+                return Walk::Collision;
+            }
+            if (state == Node::Unexpanded) {
+                uint8_t expected = Node::Unexpanded;
+                if (!node.state.compare_exchange_strong(expected, Node::Expanding, std::memory_order_acquire)) {
+                    revert(leaf);
+                    return Walk::Collision;
+                }
+                int ply = leaf.length - 1;
+                seldepth_at_least(ply);
+
+                Position& pos = leaf.position;
+                pos.generate_moves();
+                if (pos.move_list.empty() || pos.halfmove >= 100) {
+                    node.result = (pos.move_list.empty() && in_check(pos)) ? -1 : 0;
+                    node.state.store(Node::Terminal, std::memory_order_release);
+                    leaf.value = node.result;
+                    return Walk::Known;
+                }
+                // Too deep to grow further: evaluate it again next time
+                if (ply >= MAX_PLY) {
+                    node.state.store(Node::Unexpanded, std::memory_order_release);
+                    return Walk::Evaluate;
+                }
+                if (!expand(node, pos)) {
+                    node.state.store(Node::Unexpanded, std::memory_order_release);
+                    revert(leaf);
+                    return Walk::Full;
+                }
+                node.state.store(Node::Expanded, std::memory_order_release);
+                return Walk::Evaluate;
+            }
+
+            index = select_child(node);
+            leaf.position = makemove(arena[index].move, leaf.position);
+        }
+    }
+
+    void seldepth_at_least(int ply) {
+        int current = seldepth.load(std::memory_order_relaxed);
+        while (ply > current && !seldepth.compare_exchange_weak(current, ply, std::memory_order_relaxed)) {}
+    }
+
+    // `value` is for the side to move at the leaf; each node keeps results
+    // for the side that moved into it
+    void backup(const Leaf& leaf, float value) {
+        float result = -value;
+        for (int i = leaf.length - 1; i >= 0; --i) {
+            Node& node = arena[leaf.path[i]];
+            node.value.fetch_add(static_cast<int64_t>(std::llround((result + 1.0f) * SCALE)), std::memory_order_relaxed);
+            result = -result;
+        }
+    }
+
+    void revert(const Leaf& leaf) {
+        for (int i = 0; i < leaf.length; ++i) {
+            Node& node = arena[leaf.path[i]];
+            node.visits.fetch_sub(1, std::memory_order_relaxed);
+            node.value.fetch_add(SCALE, std::memory_order_relaxed);
+        }
+    }
+};
+
+// Root children, most visited first
+std::vector<uint32_t> ranked_children(Arena& arena) {
+    Node& root = arena[0];
+    std::vector<uint32_t> children;
+    if (root.state.load(std::memory_order_acquire) != Node::Expanded) return children;
+    for (uint32_t i = 0; i < root.child_count; ++i) children.push_back(root.first_child + i);
+    std::stable_sort(children.begin(), children.end(), [&](uint32_t a, uint32_t b) {
+        return arena[a].visits.load(std::memory_order_relaxed) > arena[b].visits.load(std::memory_order_relaxed);
+    });
+    return children;
+}
+
+// Most visited line below a root child
+std::vector<Move> principal_variation(Arena& arena, uint32_t index, int max_length) {
+    std::vector<Move> pv;
+    for (;;) {
+        Node& node = arena[index];
+        pv.push_back(node.move);
+        if (static_cast<int>(pv.size()) >= max_length
+            || node.state.load(std::memory_order_acquire) != Node::Expanded) break;
+        uint32_t best = Arena::NONE;
+        int32_t most = 0;
+        for (uint32_t i = node.first_child; i < node.first_child + node.child_count; ++i) {
+            int32_t visits = arena[i].visits.load(std::memory_order_relaxed);
+            if (visits > most) {
+                most = visits;
+                best = i;
+            }
+        }
+        if (best == Arena::NONE) break;
+        index = best;
+    }
+    return pv;
+}
+
+} // namespace
+
+//----------------------------------------------------------------------
+// Arena and tree
+//----------------------------------------------------------------------
+
+void Arena::reserve(size_t count) {
+    if (slots != count) {
+        nodes.reset(new Node[count]);
+        slots = count;
+    }
+    reset();
+}
+
+uint32_t Arena::allocate(size_t count) {
+    size_t begin = used.fetch_add(count, std::memory_order_relaxed);
+    return begin + count <= slots ? static_cast<uint32_t>(begin) : NONE;
+}
+
+int32_t Tree::set_root(const Position& root) {
+    if (arenas[0].capacity() == 0) {
+        size_t count = arena_mb * 1024 * 1024 / sizeof(Node);
+        arenas[0].reserve(count);
+        arenas[1].reserve(count);
+    }
+
+    // The new root among the last root, its children and grandchildren
+    Arena& from = arenas[active];
+    uint32_t found = Arena::NONE;
+    if (has_root && position.hash_key == root.hash_key) {
+        found = 0;
+    } else if (has_root && from[0].state.load() == Node::Expanded) {
+        for (uint32_t i = from[0].first_child; found == Arena::NONE && i < from[0].first_child + from[0].child_count; ++i) {
+            Position child = makemove(from[i].move, position);
+            if (child.hash_key == root.hash_key) {
+                found = i;
+                break;
+            }
+            if (from[i].state.load() != Node::Expanded) continue;
+            for (uint32_t j = from[i].first_child; j < from[i].first_child + from[i].child_count; ++j) {
+                if (makemove(from[j].move, child).hash_key == root.hash_key) {
+                    found = j;
+                    break;
+                }
+            }
+        }
+    }
+
+    position = root;
+    has_root = true;
+
+    if (found == Arena::NONE) {
+        from.reset();
+        init_node(from[from.allocate(1)], 0, 1.0f);
+        return 0;
+    }
+    if (found == 0) return from[0].visits.load();
+
+    // Copy the subtree breadth first into the other arena
+    Arena& to = arenas[active ^ 1];
+    to.reset();
+    copy_node(from[found], to[to.allocate(1)]);
+    std::vector<std::pair<uint32_t, uint32_t>> queue = {{found, 0}};
+    for (size_t q = 0; q < queue.size(); ++q) {
+        Node& source = from[queue[q].first];
+        Node& target = to[queue[q].second];
+        if (source.state.load() != Node::Expanded) continue;
+        uint32_t block = to.allocate(source.child_count);
+        if (block == Arena::NONE) {
+            target.visits.store(0);     // statistics without children would mislead selection
+            target.value.store(0);
+            continue;
+        }
+        for (uint32_t i = 0; i < source.child_count; ++i) {
+            copy_node(from[source.first_child + i], to[block + i]);
+            queue.push_back({source.first_child + i, block + i});
+        }
+        target.first_child = block;
+        target.child_count = source.child_count;
+        target.state.store(Node::Expanded);
+    }
+    active ^= 1;
+    return to[0].visits.load();
+}
+
+//----------------------------------------------------------------------
+// Search
+//----------------------------------------------------------------------
+
+template<typename Evaluator>
+Move search(Position position, const SearchLimits& limits, SearchOutput output, std::vector<PVLine>* lines) {
+    const bool verbose = (output == SearchOutput::Human);
+    const bool uci = (output == SearchOutput::Uci);
+    TimeManager& timer = *search_context.timer;
+    Tree& tree = current_tree();
+
+    SearchStats::bind_thread(0);
+    SearchStats::reset_counters();
+    if (lines) lines->clear();
+
+    position.generate_moves();
+    if (position.move_list.empty()) return 0;
+
+    // Playouts are counted here, not by the time manager
+    SearchLimits clock_limits = limits;
+    clock_limits.nodes = 0;
+    timer.start(clock_limits, position.SideToMove);
+    uint64_t max_playouts = limits.nodes;
+    if (!max_playouts && limits.depth > 0 && !timer.is_time_managed() && !limits.infinite)
+        max_playouts = static_cast<uint64_t>(limits.depth) * PLAYOUTS_PER_DEPTH;
+
+    if (position.move_list.size() == 1 && timer.is_time_managed()) {
+        if (verbose) std::cout << "Only one legal move." << std::endl;
+        if (lines) lines->push_back({position.move_list[0], 0, {position.move_list[0]}});
+        SearchStats::finish();
+        return position.move_list[0];
+    }
+
+    int32_t reused = tree.set_root(position);
+    if (verbose) std::cout << "MCTS search, " << reused << " visits reused" << std::endl;
+
+    Arena& arena = tree.nodes();
+    Searcher<Evaluator> searcher(tree, timer, max_playouts);
+    const int pv_count = std::clamp(active_multi_pv(), 1, static_cast<int>(position.move_list.size()));
+
+    auto print_info = [&]() {
+        int64_t elapsed = timer.elapsed_ms();
+        uint64_t nodes = searcher.playouts.load(std::memory_order_relaxed);
+        std::vector<uint32_t> ranked = ranked_children(arena);
+        for (int k = 0; k < pv_count && k < static_cast<int>(ranked.size()); ++k) {
+            std::vector<Move> pv = principal_variation(arena, ranked[k], MAX_PLY);
+            std::cout << "info depth " << pv.size()
+                      << " seldepth " << searcher.seldepth.load(std::memory_order_relaxed)
+                      << " multipv " << k + 1
+                      << " score cp " << value_to_cp(mean_value(arena[ranked[k]]))
+                      << " nodes " << nodes
+                      << " nps " << (elapsed > 0 ? nodes * 1000 / elapsed : nodes)
+                      << " time " << elapsed
+                      << " pv";
+            for (Move m : pv) std::cout << ' ' << move_to_uci(m);
+            std::cout << std::endl;
+        }
+    };
+
+    std::vector<std::thread> helpers;
+    for (int t = 1; t < search_threads; ++t) {
+        helpers.emplace_back([&searcher, t, context = search_context]() {
+            searcher.work(t, context, nullptr);
+        });
+    }
+    searcher.work(0, search_context, uci ? std::function<void()>(print_info) : nullptr);
+    for (std::thread& helper : helpers) helper.join();
+    SearchStats::finish();
+
+    std::vector<uint32_t> ranked = ranked_children(arena);
+    if (ranked.empty()) return position.move_list[0];
+    Move best = arena[ranked[0]].move;
+
+    if (uci) print_info();
+    if (verbose) {
+        std::cout << "MCTS completed in " << timer.elapsed_ms() << "ms, playouts: "
+                  << searcher.playouts.load() << ", tree nodes: " << arena.size()
+                  << ", best: " << move_to_uci(best) << " (score: "
+                  << value_to_cp(mean_value(arena[ranked[0]])) << ", visits: "
+                  << arena[ranked[0]].visits.load() << ")" << std::endl;
+    }
+    if (lines) {
+        for (int k = 0; k < pv_count && k < static_cast<int>(ranked.size()); ++k) {
+            Node& child = arena[ranked[k]];
+            lines->push_back({child.move, value_to_cp(mean_value(child)), principal_variation(arena, ranked[k], MAX_PLY)});
+        }
+    }
+    return best;
+}
+
+template Move search<BasicEvaluator>(Position, const SearchLimits&, SearchOutput, std::vector<PVLine>*);
+template Move search<PestoEvaluator>(Position, const SearchLimits&, SearchOutput, std::vector<PVLine>*);
+
+}
@@ -0,0 +1,102 @@
+#ifndef MCTS_HPP
+#define MCTS_HPP
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <vector>
+#include "position.hpp"
+#include "movedef.hpp"
+#include "search.hpp"
+#include "types.hpp"
+
+//----------------------------------------------------------------------
+// Monte Carlo tree search
+//
+// PUCT selection over a tree shared by all search threads (tree
+// parallelism): a thread walking down adds a virtual loss to every node
+// on its path so the others spread out, and removes it when it backs the
+// real result up. Each thread gathers a batch of leaves before evaluating
+// them in one call, the hook for a value network; the static evaluators
+// settle captures with a quiescence search first. Priors come from a
+// softmax over cheap move features (captures, promotions).
+//
+// Nodes live in an arena: children of a node are one contiguous block
+// taken with a single atomic bump, and nothing is freed individually.
+// When the next search starts from a position of the last tree (up to
+// two plies below its root) that subtree is copied into the second arena
+// and the search goes on from its statistics.
+//----------------------------------------------------------------------
+
+namespace Mcts {
+
+struct Node {
+    enum State : uint8_t { Unexpanded, Expanding, Expanded, Terminal };
+
+    Move move = 0;
+    float prior = 0.0f;
+    std::atomic<int32_t> visits{0};     // virtual losses included while in flight
+    std::atomic<int64_t> value{0};      // results for the side that played `move`, fixed point
+    uint32_t first_child = 0;
+    uint16_t child_count = 0;
+    std::atomic<uint8_t> state{Unexpanded};
+    int8_t result = 0;                  // Terminal: 0 draw, -1 side to move mated
+};
+
+class Arena {
+public:
+    static constexpr uint32_t NONE = UINT32_MAX;
+
+    void reserve(size_t count);
+    void reset() { used.store(0, std::memory_order_relaxed); }
+
+    // First of `count` fresh nodes, NONE when the arena is full
+    uint32_t allocate(size_t count);
+
+    Node& operator[](uint32_t index) { return nodes[index]; }
+    size_t size() const { return used.load(std::memory_order_relaxed); }
+    size_t capacity() const { return slots; }
+
+private:
+    std::unique_ptr<Node[]> nodes;
+    size_t slots = 0;
+    std::atomic<size_t> used{0};
+};
+
+// A search tree and the position at its root, kept between searches
+class Tree {
+public:
+    static constexpr size_t DEFAULT_MB = 64;     // per arena
+
+    explicit Tree(size_t mb = DEFAULT_MB) : arena_mb(mb) {}
+
+    // The next search starts from an empty tree
+    void clear() { has_root = false; }
+
+    // Installs `position` as the root, keeping the matching subtree of the
+    // previous search when there is one. Returns the visits kept.
+    int32_t set_root(const Position& position);
+
+    Arena& nodes() { return arenas[active]; }
+    Node& root() { return arenas[active][0]; }
+    const Position& root_position() const { return position; }
+
+private:
+    size_t arena_mb;
+    Arena arenas[2];
+    int active = 0;
+    bool has_root = false;
+    Position position;
+};
+
+// Search entry point used by findbestmove when the MCTS algorithm is
+// selected. Limits: nodes caps the playouts, depth N alone means
+// N * PLAYOUTS_PER_DEPTH playouts, the clock and movetime as usual.
+static constexpr uint64_t PLAYOUTS_PER_DEPTH = 1000;
+
+template<typename Evaluator>
+Move search(Position position, const SearchLimits& limits, SearchOutput output, std::vector<PVLine>* lines);
+
+}
+
+#endif // MCTS_HPP
@@ -0,0 +1,242 @@
+//----------------------------------------------------------------------
+// Microbenchmarks for the hot primitives (make microbench)
+//
+// Each primitive runs in a loop over the bench position set until it has
+// taken at least MIN_TIME_MS, and is reported as ns per operation. On Linux
+// the loop is also measured with perf_event_open hardware counters (cycles,
+// instructions, branch misses, L1d read misses), per operation. Counters
+// the kernel refuses (containers, perf_event_paranoid) print as "-".
+//
+// Usage: lumin_microbench [filter]   runs only the benchmarks whose name
+//                                    contains `filter`
+//----------------------------------------------------------------------
+
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <cstring>
+#include <string>
+#include <sstream>
+#include <vector>
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+#include "bench.hpp"
+#include "position.hpp"
+#include "attacks.hpp"
+#include "magic.hpp"
+#include "nonmagic.hpp"
+#include "Evaluation/evaluator.hpp"
+
+static constexpr double MIN_TIME_MS = 250.0;
+
+// Results are folded into this so the compiler cannot drop the work
+static volatile U64 sink = 0;
+
+//----------------------------------------------------------------------
+// Hardware counters
+//----------------------------------------------------------------------
+
+class PerfCounters {
+public:
+    enum Counter { Cycles, Instructions, BranchMisses, L1dMisses, COUNT };
+
+    PerfCounters() {
+#ifdef __linux__
+        const uint64_t l1d_read_miss = PERF_COUNT_HW_CACHE_L1D
+                                     | (PERF_COUNT_HW_CACHE_OP_READ << 8)
+                                     | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+        fds[Cycles]       = open_counter(PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES);
+        fds[Instructions] = open_counter(PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS);
+        fds[BranchMisses] = open_counter(PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES);
+        fds[L1dMisses]    = open_counter(PERF_TYPE_HW_CACHE, l1d_read_miss);
+#endif
+    }
+
+    ~PerfCounters() {
+#ifdef __linux__
+        for (int fd : fds) if (fd >= 0) close(fd);
+#endif
+    }
+
+    bool available(Counter c) const { return fds[c] >= 0; }
+
+    void start() {
+#ifdef __linux__
+        for (int fd : fds) {
+            if (fd < 0) continue;
+            ioctl(fd, PERF_EVENT_IOC_RESET, 0);
+            ioctl(fd, PERF_EVENT_IOC_ENABLE, 0);
+        }
+#endif
+    }
+
+    void stop() {
+#ifdef __linux__
+        for (int i = 0; i < COUNT; ++i) {
+            values[i] = 0;
+            if (fds[i] < 0) continue;
+            ioctl(fds[i], PERF_EVENT_IOC_DISABLE, 0);
+            if (read(fds[i], &values[i], sizeof(values[i])) != sizeof(values[i])) values[i] = 0;
+        }
+#endif
+    }
+
+    uint64_t value(Counter c) const { return values[c]; }
+
+private:
+#ifdef __linux__
+    static int open_counter(uint32_t type, uint64_t config) {
+        perf_event_attr attr;
+        std::memset(&attr, 0, sizeof(attr));
+        attr.size = sizeof(attr);
+        attr.type = type;
+        attr.config = config;
+        attr.disabled = 1;
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+        return static_cast<int>(syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0));
+    }
+#endif
+
+    int fds[COUNT] = {-1, -1, -1, -1};
+    uint64_t values[COUNT] = {};
+};
+
+//----------------------------------------------------------------------
+// Harness
+//----------------------------------------------------------------------
+
+// `body` runs one pass over the corpus and returns how many operations it did
+template<typename Body>
+static void run(const char* name, const std::string& filter, PerfCounters& counters, Body&& body) {
+    if (!filter.empty() && std::string(name).find(filter) == std::string::npos) return;
+
+    body();   // warm-up: caches, branch predictors, lazy allocations
+
+    uint64_t ops = 0;
+    double ms = 0.0;
+    counters.start();
+    auto t0 = std::chrono::steady_clock::now();
+    while (ms < MIN_TIME_MS) {
+        ops += body();
+        ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count();
+    }
+    counters.stop();
+
+    auto per_op = [&](PerfCounters::Counter c, int precision) {
+        std::ostringstream out;
+        if (counters.available(c)) out << std::fixed << std::setprecision(precision)
+                                       << static_cast<double>(counters.value(c)) / ops;
+        else out << "-";
+        return out.str();
+    };
+
+    std::cout << std::left << std::setw(22) << name << std::right
+              << std::setw(12) << ops
+              << std::setw(11) << std::fixed << std::setprecision(2) << ms * 1e6 / ops
+              << std::setw(11) << per_op(PerfCounters::Cycles, 1)
+              << std::setw(11) << per_op(PerfCounters::Instructions, 1)
+              << std::setw(11) << per_op(PerfCounters::BranchMisses, 3)
+              << std::setw(11) << per_op(PerfCounters::L1dMisses, 3) << "\n";
+}
+
+int main(int argc, char* argv[]) {
+    init_sliders();
+    init_nonsliders();
+    init_evaluators();
+
+    std::string filter = argc > 1 ? argv[1] : "";
+
+    const std::vector<std::string>& fens = bench_positions();
+    std::vector<Position> corpus;
+    for (const std::string& fen : fens) {
+        corpus.push_back(parsefen(fen));
+        corpus.back().generate_moves();
+    }
+
+    PerfCounters counters;
+    std::cout << "Corpus: " << corpus.size() << " positions"
+              << (counters.available(PerfCounters::Cycles) ? "" : " (hardware counters unavailable)") << "\n\n"
+              << std::left << std::setw(22) << "primitive" << std::right
+              << std::setw(12) << "ops" << std::setw(11) << "ns/op" << std::setw(11) << "cycles"
+              << std::setw(11) << "instr" << std::setw(11) << "br-miss" << std::setw(11) << "L1d-miss" << "\n";
+
+    run("generate_moves", filter, counters, [&]() -> uint64_t {
+        for (Position& pos : corpus) {
+            pos.generate_moves();
+            sink = sink + pos.move_list.size();
+        }
+        return corpus.size();
+    });
+
+    run("makemove", filter, counters, [&]() -> uint64_t {
+        uint64_t ops = 0;
+        for (const Position& pos : corpus) {
+            for (Move m : pos.move_list) sink = sink ^ makemove(m, pos).hash_key;
+            ops += pos.move_list.size();
+        }
+        return ops;
+    });
+
+    run("isSquareAttacked", filter, counters, [&]() -> uint64_t {
+        for (const Position& pos : corpus) {
+            U64 attacked = 0;
+            for (int sq = 0; sq < 64; ++sq) {
+                attacked += isSquareAttacked(sq, pos, White);
+                attacked += isSquareAttacked(sq, pos, Black);
+            }
+            sink = sink + attacked;
+        }
+        return corpus.size() * 128;
+    });
+
+    run("rook_attacks", filter, counters, [&]() -> uint64_t {
+        for (const Position& pos : corpus) {
+            U64 acc = 0;
+            for (int sq = 0; sq < 64; ++sq) acc ^= rook_attacks(sq, pos.occupancies[2]);
+            sink = sink ^ acc;
+        }
+        return corpus.size() * 64;
+    });
+
+    run("bishop_attacks", filter, counters, [&]() -> uint64_t {
+        for (const Position& pos : corpus) {
+            U64 acc = 0;
+            for (int sq = 0; sq < 64; ++sq) acc ^= bishop_attacks(sq, pos.occupancies[2]);
+            sink = sink ^ acc;
+        }
+        return corpus.size() * 64;
+    });
+
+    run("Evaluate (basic)", filter, counters, [&]() -> uint64_t {
+        for (const Position& pos : corpus) sink = sink + BasicEvaluator::evaluate(pos);
+        return corpus.size();
+    });
+
+    run("Evaluate (pesto)", filter, counters, [&]() -> uint64_t {
+        for (const Position& pos : corpus) sink = sink + PestoEvaluator::evaluate(pos);
+        return corpus.size();
+    });
+
+    run("parsefen", filter, counters, [&]() -> uint64_t {
+        for (const std::string& fen : fens) sink = sink ^ parsefen(fen).hash_key;
+        return fens.size();
+    });
+
+    Position scratch;
+    run("parse_fen (reused)", filter, counters, [&]() -> uint64_t {
+        for (const std::string& fen : fens) {
+            parse_fen(fen, scratch);
+            sink = sink ^ scratch.hash_key;
+        }
+        return fens.size();
+    });
+
+    return 0;
+}
@@ -98,7 +98,7 @@ inline U64 mask_king_attacks(int square)
 }
 
 inline void init_nonsliders() {
-    std::cout << "Initializing Non-sliders...\n";
+    std::cerr << "Initializing Non-sliders...\n";
     for (int sq = 0; sq < 64; ++sq) {
         PawnAttacks[0][sq] = mask_pawn_attacks(0, sq);
         PawnAttacks[1][sq] = mask_pawn_attacks(1, sq);
@@ -1,90 +1,310 @@
 #include <iostream>
 #include <chrono>
 #include <thread>
-#include <future>
 #include <vector>
 #include <atomic>
 #include <iomanip>
+#include <fstream>
+#include <sstream>
 #include <algorithm>
+#include <array>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <condition_variable>
 
 #include "perftest.hpp"
 #include "position.hpp"
 #include "movegen.hpp"
 #include "movedef.hpp"
+#include "zobrist.hpp"
+#include "epd.hpp"
 
-// Threshold for when to use multithreading
-constexpr int THREADING_DEPTH_THRESHOLD = 4;
-constexpr size_t MIN_MOVES_FOR_THREADING = 8;
+//----------------------------------------------------------------------
+// Perft hash
+//
+// Subtree counts keyed on (Zobrist key, depth), so transpositions are only
+// counted once. Same lockless scheme as the search TT: the key is stored
+// XOR-ed with the count, a torn entry reads as a miss.
+//----------------------------------------------------------------------
 
-// Internal optimized perft function with threading control
-uint64_t perft_count_internal(int depth, Position position, int thread_depth = 0) {
-    if (depth == 0) {
-        return 1;
+struct PerftEntry {
+    U64 key;
+    U64 nodes;
+};
+
+static constexpr int MAX_PERFT_DEPTH = 32;
+
+static constexpr std::array<U64, MAX_PERFT_DEPTH + 1> make_depth_keys() {
+    std::array<U64, MAX_PERFT_DEPTH + 1> keys{};
+    U64 state = 0x7065726674ULL;
+    for (U64& key : keys) key = Zobrist::splitmix64(state);
+    return keys;
+}
+static constexpr std::array<U64, MAX_PERFT_DEPTH + 1> depth_keys = make_depth_keys();
+
+static std::vector<PerftEntry> perft_table;
+static U64 perft_mask = 0;
+
+void perft_hash_resize(size_t mb) {
+    size_t entries = std::max<size_t>(1, mb) * 1024 * 1024 / sizeof(PerftEntry);
+    size_t pow2 = 1;
+    while (pow2 * 2 <= entries) pow2 *= 2;
+
+    perft_table.assign(pow2, PerftEntry{0ULL, 0ULL});
+    perft_mask = pow2 - 1;
+}
+
+void perft_hash_clear() {
+    std::fill(perft_table.begin(), perft_table.end(), PerftEntry{0ULL, 0ULL});
+}
+
+static inline U64 perft_key(const Position& position, int depth) {
+    return position.hash_key ^ depth_keys[depth];
+}
+
+static inline bool perft_probe(U64 key, uint64_t& nodes) {
+    const PerftEntry& entry = perft_table[key & perft_mask];
+    U64 stored = entry.nodes;
+    if ((entry.key ^ stored) != key || stored == 0) return false;
+    nodes = stored;
+    return true;
+}
+
+static inline void perft_store(U64 key, uint64_t nodes) {
+    PerftEntry& entry = perft_table[key & perft_mask];
+    entry.nodes = nodes;
+    entry.key = key ^ nodes;
+}
+
+//----------------------------------------------------------------------
+// Sequential perft: bulk counting at depth 1 (the legal move list is the
+// answer, no makemove per leaf) and the perft hash from depth 2 up.
+// `position` must already have its moves generated.
+//----------------------------------------------------------------------
+
+static uint64_t perft_sequential(const Position& position, int depth) {
+    if (depth == 1) return position.move_list.size();
+
+    U64 key = perft_key(position, depth);
+    uint64_t nodes = 0;
+    if (perft_probe(key, nodes)) return nodes;
+
+    for (const Move& move : position.move_list) {
+        Position newpos = makemove(move, position);
+        newpos.generate_moves();
+        nodes += perft_sequential(newpos, depth - 1);
     }
-    
-    position.generate_moves();
-    
-    // Use single-threaded for shallow depths, few moves, or deep thread recursion
-    if (depth < THREADING_DEPTH_THRESHOLD || 
-        position.move_list.size() < MIN_MOVES_FOR_THREADING ||
-        thread_depth > 2) {
-        
-        uint64_t nodes = 0;
-        for (const Move& move : position.move_list) {
-            Position newpos = makemove(move, position);
-            if (newpos.SideToMove != position.SideToMove) {
-                nodes += perft_count_internal(depth - 1, newpos, thread_depth + 1);
-            }
+
+    perft_store(key, nodes);
+    return nodes;
+}
+
+//----------------------------------------------------------------------
+// Work-stealing pool
+//
+// A task is a (position, depth) subtree. A worker that finds its own
+// deque short splits the subtree it is running into one task per move,
+// at any depth; otherwise it counts it sequentially. Owners pop from the
+// back of their deque, idle workers steal from the front (the largest
+// subtrees). A split node is a PerftJoin: the last child to finish stores
+// the subtree count in the perft hash and passes it up to its parent, so
+// nobody ever blocks waiting for children.
+//----------------------------------------------------------------------
+
+// Subtrees smaller than this are never split
+static constexpr int MIN_SPLIT_DEPTH = 3;
+// Split only while the worker's own deque holds fewer tasks than this
+static constexpr size_t SPLIT_QUEUE_TARGET = 4;
+
+struct PerftJoin {
+    std::atomic<uint64_t> nodes{0};
+    std::atomic<int> pending{0};
+    PerftJoin* parent = nullptr;
+    U64 key = 0;
+};
+
+struct PerftTask {
+    Position position;
+    int depth;
+    PerftJoin* join;
+};
+
+class PerftPool {
+public:
+    static PerftPool& instance() {
+        static PerftPool pool(std::max(1u, std::thread::hardware_concurrency()));
+        return pool;
+    }
+
+    uint64_t run(const Position& root, int depth);
+
+    ~PerftPool();
+
+private:
+    struct Worker {
+        std::mutex lock;
+        std::deque<PerftTask> tasks;
+    };
+
+    explicit PerftPool(unsigned int thread_count);
+
+    void worker_loop(size_t id);
+    bool pop(size_t id, PerftTask& task);
+    bool steal(size_t id, PerftTask& task);
+    size_t queued(size_t id);
+    void execute(size_t id, PerftTask& task);
+    void complete(PerftJoin* join, uint64_t nodes);
+
+    std::vector<std::unique_ptr<Worker>> workers;
+    std::vector<std::thread> threads;
+
+    std::mutex job_lock;
+    std::condition_variable job_cv;
+    std::condition_variable done_cv;
+    std::atomic<bool> running{false};
+    bool quit = false;
+
+    PerftJoin* root_join = nullptr;
+    uint64_t result = 0;
+};
+
+PerftPool::PerftPool(unsigned int thread_count) {
+    for (unsigned int i = 0; i < thread_count; ++i) workers.push_back(std::make_unique<Worker>());
+    for (unsigned int i = 0; i < thread_count; ++i) threads.emplace_back(&PerftPool::worker_loop, this, i);
+}
+
+PerftPool::~PerftPool() {
+    {
+        std::lock_guard<std::mutex> lk(job_lock);
+        quit = true;
+    }
+    job_cv.notify_all();
+    for (std::thread& thread : threads) thread.join();
+}
+
+uint64_t PerftPool::run(const Position& root, int depth) {
+    PerftJoin join;
+    join.pending = 1;
+    join.key = perft_key(root, depth);
+    root_join = &join;
+
+    {
+        std::lock_guard<std::mutex> lk(workers[0]->lock);
+        workers[0]->tasks.push_back(PerftTask{root, depth, &join});
+    }
+
+    std::unique_lock<std::mutex> lk(job_lock);
+    running = true;
+    job_cv.notify_all();
+    done_cv.wait(lk, [this] { return !running; });
+
+    root_join = nullptr;
+    return result;
+}
+
+void PerftPool::worker_loop(size_t id) {
+    for (;;) {
+        {
+            std::unique_lock<std::mutex> lk(job_lock);
+            job_cv.wait(lk, [this] { return quit || running; });
+            if (quit) return;
+        }
+
+        PerftTask task;
+        while (running) {
+            if (pop(id, task) || steal(id, task)) execute(id, task);
+            else std::this_thread::yield();
         }
-        return nodes;
     }
-    
-    // Multithreaded version
-    const size_t num_moves = position.move_list.size();
-    const unsigned int num_threads = std::min(
-        std::thread::hardware_concurrency(),
-        static_cast<unsigned int>(num_moves)
-    );
-    
-    std::atomic<uint64_t> total_nodes{0};
-    std::vector<std::future<void>> futures;
-    futures.reserve(num_threads);
-    
-    // Calculate work distribution
-    const size_t chunk_size = (num_moves + num_threads - 1) / num_threads;
-    
-    for (unsigned int t = 0; t < num_threads; ++t) {
-        size_t start = t * chunk_size;
-        size_t end = std::min(start + chunk_size, num_moves);
-        
-        if (start >= num_moves) break;
-        
-        futures.emplace_back(std::async(std::launch::async, [&, start, end, thread_depth]() {
-            uint64_t local_nodes = 0;
-            for (size_t i = start; i < end; ++i) {
-                Position newpos = makemove(position.move_list[i], position);
-                if (newpos.SideToMove != position.SideToMove) {
-                    local_nodes += perft_count_internal(depth - 1, newpos, thread_depth + 1);
-                }
-            }
-            total_nodes += local_nodes;
-        }));
+}
+
+bool PerftPool::pop(size_t id, PerftTask& task) {
+    Worker& worker = *workers[id];
+    std::lock_guard<std::mutex> lk(worker.lock);
+    if (worker.tasks.empty()) return false;
+    task = std::move(worker.tasks.back());
+    worker.tasks.pop_back();
+    return true;
+}
+
+bool PerftPool::steal(size_t id, PerftTask& task) {
+    for (size_t k = 1; k < workers.size(); ++k) {
+        Worker& victim = *workers[(id + k) % workers.size()];
+        std::lock_guard<std::mutex> lk(victim.lock);
+        if (victim.tasks.empty()) continue;
+        task = std::move(victim.tasks.front());
+        victim.tasks.pop_front();
+        return true;
     }
-    
-    // Wait for all threads to complete
-    for (auto& future : futures) {
-        future.wait();
+    return false;
+}
+
+size_t PerftPool::queued(size_t id) {
+    Worker& worker = *workers[id];
+    std::lock_guard<std::mutex> lk(worker.lock);
+    return worker.tasks.size();
+}
+
+void PerftPool::execute(size_t id, PerftTask& task) {
+    Position& position = task.position;
+    position.generate_moves();
+
+    if (task.depth < MIN_SPLIT_DEPTH || position.move_list.size() < 2 || queued(id) >= SPLIT_QUEUE_TARGET) {
+        complete(task.join, perft_sequential(position, task.depth));
+        return;
+    }
+
+    U64 key = perft_key(position, task.depth);
+    uint64_t nodes = 0;
+    if (perft_probe(key, nodes)) {
+        complete(task.join, nodes);
+        return;
+    }
+
+    PerftJoin* join = new PerftJoin;
+    join->pending = static_cast<int>(position.move_list.size());
+    join->parent = task.join;
+    join->key = key;
+
+    Worker& worker = *workers[id];
+    std::lock_guard<std::mutex> lk(worker.lock);
+    for (const Move& move : position.move_list) {
+        worker.tasks.push_back(PerftTask{makemove(move, position), task.depth - 1, join});
+    }
+}
+
+void PerftPool::complete(PerftJoin* join, uint64_t nodes) {
+    while (join) {
+        join->nodes += nodes;
+        if (join->pending.fetch_sub(1) != 1) return;
+
+        // Last child in: the subtree is done
+        nodes = join->nodes.load();
+        perft_store(join->key, nodes);
+        PerftJoin* parent = join->parent;
+
+        if (join == root_join) {
+            std::lock_guard<std::mutex> lk(job_lock);
+            result = nodes;
+            running = false;
+            done_cv.notify_all();
+            return;
+        }
+        delete join;
+        join = parent;
     }
-    
-    return total_nodes.load();
 }
 
-// Main perft_count function (maintains original signature)
 uint64_t perft_count(int depth, Position position) {
-    return perft_count_internal(depth, position, 0);
+    if (depth <= 0) return 1;
+    if (depth > MAX_PERFT_DEPTH) depth = MAX_PERFT_DEPTH;
+    if (perft_table.empty()) perft_hash_resize(PERFT_HASH_DEFAULT_MB);
+    return PerftPool::instance().run(position, depth);
 }
 
-// Optimized perft_divide function (maintains original signature)
+// Per-move breakdown. Each subtree is counted by the pool, which is
+// already parallel, so the root moves are simply taken in turn.
 void perft_divide(int depth, Position position) {
     if (depth <= 0) return;
     
@@ -93,70 +313,24 @@ void perft_divide(int depth, Position position) {
     std::cout << "\nPerft divide at depth " << depth << ":\n";
     std::cout << "----------------------------------------\n";
     
-    const size_t num_moves = position.move_list.size();
-    
-    // For very few moves or shallow depth, use single-threaded
-    if (num_moves < MIN_MOVES_FOR_THREADING || depth <= 2) {
-        uint64_t total_nodes = 0;
-        for (const Move& move : position.move_list) {
-            Position newpos = makemove(move, position);
-            if (newpos.SideToMove != position.SideToMove) {
-                uint64_t move_nodes = (depth == 1) ? 1 : perft_count(depth - 1, newpos);
-                total_nodes += move_nodes;
-                
-                std::cout << square_to_coordinates[get_move_source(move)]
-                         << square_to_coordinates[get_move_target(move)]
-                         << ": " << move_nodes << std::endl;
-            }
-        }
-        std::cout << "----------------------------------------\n";
-        std::cout << "Total nodes: " << total_nodes << std::endl;
-        return;
-    }
-    
-    // Multithreaded version
-    std::atomic<uint64_t> total_nodes{0};
-    std::vector<std::pair<Move, uint64_t>> results(num_moves);
-    std::vector<std::future<void>> futures;
-    futures.reserve(num_moves);
-    
-    // Process each move in parallel
-    for (size_t i = 0; i < num_moves; ++i) {
-        futures.emplace_back(std::async(std::launch::async, [&, i]() {
-            Move move = position.move_list[i];
-            Position newpos = makemove(move, position);
-            
-            if (newpos.SideToMove != position.SideToMove) {
-                uint64_t move_nodes = (depth == 1) ? 1 : perft_count(depth - 1, newpos);
-                total_nodes += move_nodes;
-                results[i] = {move, move_nodes};
-            } else {
-                results[i] = {move, 0}; // Invalid move
-            }
-        }));
-    }
-    
-    // Wait for all tasks to complete
-    for (auto& future : futures) {
-        future.wait();
-    }
-    
-    // Output results in original order
-    for (const auto& [move, move_nodes] : results) {
-        if (move_nodes > 0) {
-            std::cout << square_to_coordinates[get_move_source(move)]
-                     << square_to_coordinates[get_move_target(move)]
-                     << ": " << move_nodes << std::endl;
-        }
+    uint64_t total_nodes = 0;
+    for (const Move& move : position.move_list) {
+        uint64_t move_nodes = perft_count(depth - 1, makemove(move, position));
+        total_nodes += move_nodes;
+
+        std::cout << square_to_coordinates[get_move_source(move)]
+                  << square_to_coordinates[get_move_target(move)]
+                  << ": " << move_nodes << std::endl;
     }
     
     std::cout << "----------------------------------------\n";
-    std::cout << "Total nodes: " << total_nodes.load() << std::endl;
+    std::cout << "Total nodes: " << total_nodes << std::endl;
 }
 
 // Enhanced perftcheck function with better performance reporting
 void perftcheck(const std::string& fen,
-                const std::vector<std::pair<int, uint64_t>>& expected_results)
+                const std::vector<std::pair<int, uint64_t>>& expected_results,
+                int divide_depth)
 {
     // 1) Set up the position from FEN (or use the default ctor for "startpos")
     Position position;
@@ -188,26 +362,116 @@ void perftcheck(const std::string& fen,
                   << std::scientific << std::setprecision(2) << nps << " nps]\n";
     }
 
-    // 3) Show a per-move breakdown at depth 2
-    std::cout << "\nPerft-divide at depth 5:\n";
+    // 3) Optional per-move breakdown
+    if (divide_depth <= 0) return;
     auto t0 = std::chrono::high_resolution_clock::now();
-    perft_divide(5, position);
+    perft_divide(divide_depth, position);
     auto t1 = std::chrono::high_resolution_clock::now();
     
     auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(t1 - t0).count();
     std::cout << "Perft-divide completed in " << ms << " ms\n";
 }
 
-// Working example
-/*
-std::string pos1 = "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq -";
-    // Known perft counts for Kiwipete:
-    std::vector<std::pair<int, uint64_t>> pos1_results = {
-        {1,     48ULL},
-        {2,   2039ULL},
-        {3,  97862ULL},
-        {4, 4085603ULL},
-        {5, 193690690ULL}
-    };
-    perftcheck(pos1, pos1_results);
-*/
+//----------------------------------------------------------------------
+// Perft suite
+//
+// EPD lines of the form   <fen> ;D1 20 ;D2 400 ...
+// Every depth whose expected count is at most max_nodes is run (each one
+// with a cold perft hash, so the timings are comparable between runs).
+// JSON goes to stdout, one progress line per entry to stderr.
+//----------------------------------------------------------------------
+
+struct PerftSuiteEntry {
+    std::string fen;
+    Position position;
+    std::vector<std::pair<int, uint64_t>> expected;
+};
+
+static bool read_perft_suite(const std::string& path, std::vector<PerftSuiteEntry>& entries) {
+    EpdFile file(path);
+    if (!file.is_open()) return false;
+
+    std::string_view line, operations;
+    size_t line_number = 0;
+    while (file.next(line, line_number)) {
+        PerftSuiteEntry entry;
+        FenError error = parse_epd(line, entry.position, operations);
+        if (error != FenError::None) {
+            std::cerr << path << ":" << line_number << ": " << fen_error_string(error) << "\n";
+            continue;
+        }
+        entry.fen = entry.position.get_fen();
+
+        // ";D<depth> <count>" operations
+        while (!operations.empty()) {
+            size_t semi = operations.find(';');
+            std::string_view operation = operations.substr(0, semi);
+            operations.remove_prefix(semi == std::string_view::npos ? operations.size() : semi + 1);
+
+            std::string_view tag = next_token(operation);
+            std::string_view count = next_token(operation);
+            if (tag.size() > 1 && tag[0] == 'D' && !count.empty()) {
+                entry.expected.push_back({std::atoi(std::string(tag.substr(1)).c_str()),
+                                          std::strtoull(std::string(count).c_str(), nullptr, 10)});
+            }
+        }
+        entries.push_back(std::move(entry));
+    }
+    return true;
+}
+
+int perft_suite(const std::string& path, uint64_t max_nodes) {
+    std::vector<PerftSuiteEntry> entries;
+    if (!read_perft_suite(path, entries)) {
+        std::cerr << "Cannot read " << path << "\n";
+        return -1;
+    }
+
+    int failures = 0;
+    uint64_t total_nodes = 0;
+    double total_ms = 0.0;
+    bool first = true;
+
+    std::cout << "{\n  \"suite\": \"" << path << "\",\n"
+              << "  \"threads\": " << std::max(1u, std::thread::hardware_concurrency()) << ",\n"
+              << "  \"results\": [";
+
+    for (const PerftSuiteEntry& entry : entries) {
+        const Position& position = entry.position;
+
+        for (auto [depth, expected] : entry.expected) {
+            if (expected > max_nodes) continue;
+
+            perft_hash_clear();
+            auto t0 = std::chrono::steady_clock::now();
+            uint64_t nodes = perft_count(depth, position);
+            double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count();
+            uint64_t nps = ms > 0 ? static_cast<uint64_t>(nodes * 1000.0 / ms) : 0;
+            bool pass = (nodes == expected);
+
+            failures += !pass;
+            total_nodes += nodes;
+            total_ms += ms;
+
+            std::cerr << (pass ? "PASS " : "FAIL ") << "D" << depth << " " << nodes
+                      << " (expected " << expected << ") " << entry.fen << "\n";
+
+            std::cout << (first ? "\n" : ",\n")
+                      << "    {\"fen\": \"" << entry.fen << "\", \"depth\": " << depth
+                      << ", \"expected\": " << expected << ", \"nodes\": " << nodes
+                      << ", \"time_ms\": " << std::fixed << std::setprecision(3) << ms
+                      << ", \"nps\": " << nps
+                      << ", \"pass\": " << (pass ? "true" : "false") << "}";
+            first = false;
+        }
+    }
+
+    uint64_t total_nps = total_ms > 0 ? static_cast<uint64_t>(total_nodes * 1000.0 / total_ms) : 0;
+    std::cout << "\n  ],\n"
+              << "  \"total_nodes\": " << total_nodes << ",\n"
+              << "  \"total_time_ms\": " << std::fixed << std::setprecision(3) << total_ms << ",\n"
+              << "  \"nps\": " << total_nps << ",\n"
+              << "  \"failures\": " << failures << "\n}" << std::endl;
+
+    return failures;
+}
@@ -4,9 +4,20 @@
 #include <iostream>
 #include "position.hpp"
 
+// Perft hash size used on the first perft_count call
+constexpr size_t PERFT_HASH_DEFAULT_MB = 64;
+
 uint64_t perft_count(int depth, Position position);
+void perft_hash_resize(size_t mb);
+void perft_hash_clear();
 void perft_divide(int depth, Position position);
 void perftcheck(const std::string& fen,
-                const std::vector<std::pair<int, uint64_t>>& expected_results);
+                const std::vector<std::pair<int, uint64_t>>& expected_results,
+                int divide_depth = 0);
+
+// Runs every "<fen> ;D<n> <count>" entry of an EPD file whose count is at
+// most max_nodes and prints a JSON report. Returns the number of
+// mismatches, or -1 if the file cannot be read.
+int perft_suite(const std::string& path, uint64_t max_nodes);
 
 #endif
\ No newline at end of file
@@ -5,89 +5,174 @@
 #include "magic.hpp"
 #include "types.hpp"
 #include "movedef.hpp"
+#include "zobrist.hpp"
 #include <iostream>
 #include <sstream>
 #include <vector>
 #include <algorithm>
 
 //–– parseFEN ––
-Position parsefen(const std::string &fen) {
-    Position position;
-    position.emptyBoard();
+const char* fen_error_string(FenError error) {
+    switch (error) {
+        case FenError::None:       return "ok";
+        case FenError::Placement:  return "invalid piece placement";
+        case FenError::Kings:      return "each side needs exactly one king";
+        case FenError::SideToMove: return "invalid side to move";
+        case FenError::Castling:   return "invalid castling rights";
+        case FenError::EnPassant:  return "invalid en passant square";
+        case FenError::Halfmove:   return "invalid half-move clock";
+        case FenError::Fullmove:   return "invalid full-move number";
+        case FenError::Trailing:   return "unexpected text after the FEN";
+    }
+    return "unknown error";
+}
 
-    // 1) Split FEN into its 6 fields
-    std::istringstream iss(fen);
-    std::string boardPart, stmPart, castlePart, epPart;
-    int halfmoveClock, fullmoveNumber;
-    iss >> boardPart >> stmPart >> castlePart >> epPart
-        >> halfmoveClock >> fullmoveNumber;
-    // 2) Piece placement: start at a8, move left‑to‑right, top‑to‑bottom
-    int sq = a8;
-    for (char c : boardPart) {
-        if (std::isdigit(c)) {
-            sq += c - '0';             // skip empty squares
-        }
-        else if (c == '/') {
-            continue; // Move to start of next rank
+static bool is_blank(char c) {
+    return c == ' ' || c == '\t' || c == '\r' || c == '\n';
+}
+
+// Next whitespace separated field of `text`, starting the search at `pos`
+static std::string_view next_field(std::string_view text, size_t& pos) {
+    while (pos < text.size() && is_blank(text[pos])) ++pos;
+    size_t start = pos;
+    while (pos < text.size() && !is_blank(text[pos])) ++pos;
+    return text.substr(start, pos - start);
+}
+
+static bool is_number(std::string_view field) {
+    if (field.empty() || field.size() > 5) return false;
+    for (char c : field) if (c < '0' || c > '9') return false;
+    return true;
+}
+
+static uint32_t to_number(std::string_view field) {
+    uint32_t value = 0;
+    for (char c : field) value = value * 10 + (c - '0');
+    return value;
+}
+
+static int piece_from_char(char c) {
+    switch (c) {
+        case 'P': return wP; case 'N': return wN; case 'B': return wB;
+        case 'R': return wR; case 'Q': return wQ; case 'K': return wK;
+        case 'p': return bP; case 'n': return bN; case 'b': return bB;
+        case 'r': return bR; case 'q': return bQ; case 'k': return bK;
+        default:  return Em;
+    }
+}
+
+FenError parse_fen(std::string_view fen, Position& position, size_t* consumed) {
+    position.emptyBoard();
+    position.move_list.clear();
+    position.FiftyMove = false;
+
+    // 1) Piece placement: rank 8 first, files a to h (square 0 is a8)
+    size_t pos = 0;
+    std::string_view placement = next_field(fen, pos);
+    int row = 0, file = 0;
+    for (char c : placement) {
+        if (c == '/') {
+            if (file != 8 || row == 7) return FenError::Placement;
+            ++row;
+            file = 0;
+        } else if (c >= '1' && c <= '8') {
+            file += c - '0';
+            if (file > 8) return FenError::Placement;
+        } else {
+            int piece = piece_from_char(c);
+            if (piece == Em || file >= 8) return FenError::Placement;
+            set_bit(position.bitboards[piece], (row * 8 + file));
+            ++file;
         }
-        else {
-            Piece p;
+    }
+    if (row != 7 || file != 8) return FenError::Placement;
+    if (count_bits(position.bitboards[wK]) != 1 || count_bits(position.bitboards[bK]) != 1)
+        return FenError::Kings;
+
+    // 2) Side to move
+    std::string_view side = next_field(fen, pos);
+    if (side != "w" && side != "b") return FenError::SideToMove;
+    position.SideToMove = (side == "w") ? White : Black;
+
+    // 3) Castling rights
+    std::string_view castling = next_field(fen, pos);
+    position.castling = 0;
+    if (castling.empty()) return FenError::Castling;
+    if (castling != "-") {
+        for (char c : castling) {
             switch (c) {
-                case 'P': p = wP; break;
-                case 'N': p = wN; break;
-                case 'B': p = wB; break;
-                case 'R': p = wR; break;
-                case 'Q': p = wQ; break;
-                case 'K': p = wK; break;
-                case 'p': p = bP; break;
-                case 'n': p = bN; break;
-                case 'b': p = bB; break;
-                case 'r': p = bR; break;
-                case 'q': p = bQ; break;
-                case 'k': p = bK; break;
-                default:  p = Em;  break;
+                case 'K': position.castling |= wk; break;
+                case 'Q': position.castling |= wq; break;
+                case 'k': position.castling |= bk; break;
+                case 'q': position.castling |= bq; break;
+                default:  return FenError::Castling;
             }
-            set_bit(position.bitboards[p], sq);
-            ++sq;
         }
     }
-    
-    // 3) Side to move
-    position.SideToMove = (stmPart == "w" ? White : Black);
 
-    // 4) Castling rights
-    position.castling = 0;
-    if (castlePart.find('K') != std::string::npos) position.castling |= wk;
-    if (castlePart.find('Q') != std::string::npos) position.castling |= wq;
-    if (castlePart.find('k') != std::string::npos) position.castling |= bk;
-    if (castlePart.find('q') != std::string::npos) position.castling |= bq;
-    
-    // 5) En passant target
-    if (epPart != "-") {
-        int file = epPart[0] - 'a';
-        int rank = '9' - epPart[1] - 1;
-        position.enpassant = rank * 8 + file;
-    } else {
+    // 4) En passant target
+    std::string_view ep = next_field(fen, pos);
+    if (ep == "-") {
         position.enpassant = no_sq;
+    } else if (ep.size() == 2 && ep[0] >= 'a' && ep[0] <= 'h' && (ep[1] == '3' || ep[1] == '6')) {
+        position.enpassant = ('8' - ep[1]) * 8 + (ep[0] - 'a');
+    } else {
+        return FenError::EnPassant;
     }
 
+    // 5) + 6) Optional move counters (missing in EPD)
+    position.halfmove = 0;
+    position.fullmove = 1;
+    size_t end = pos;
+    std::string_view field = next_field(fen, pos);
+    if (is_number(field)) {
+        position.halfmove = static_cast<uint16_t>(to_number(field));
+        end = pos;
+        field = next_field(fen, pos);
+        if (is_number(field)) {
+            uint32_t fullmove = to_number(field);
+            if (fullmove > 0xFFFF) return FenError::Fullmove;
+            // Many puzzle and EPD sources write "... 1 0": read 0 as move 1
+            position.fullmove = static_cast<uint16_t>(fullmove == 0 ? 1 : fullmove);
+            end = pos;
+            field = next_field(fen, pos);
+        } else if (!consumed && !field.empty()) {
+            return FenError::Fullmove;
+        }
+    } else if (!consumed && !field.empty() && field[0] >= '0' && field[0] <= '9') {
+        return FenError::Halfmove;
+    }
+    if (consumed) {
+        *consumed = end;
+    } else if (!field.empty()) {
+        return FenError::Trailing;
+    }
+    position.FiftyMove = position.halfmove >= 100;
 
-    // 6) Rebuild occupancy bitboards
+    // Rebuild occupancy bitboards and the hash key
     position.compute_occupancies();
-    
-    if(halfmoveClock == 100) position.FiftyMove = true;
+    position.hash_key = generate_hash_key(position);
+    return FenError::None;
+}
 
+Position parsefen(const std::string &fen) {
+    Position position;
+    FenError error = parse_fen(fen, position);
+    if (error != FenError::None) {
+        std::cerr << "Invalid FEN (" << fen_error_string(error) << "): " << fen << std::endl;
+        return Position();
+    }
     return position;
 }
 
 std::string Position::get_fen() const {
     std::ostringstream oss;
 
-    // 1) Piece placement
+    // 1) Piece placement, rank 8 first (square 0 is a8)
     for (int rank = 7; rank >= 0; --rank) {
         int empty = 0;
         for (int file = 0; file < 8; ++file) {
-            int sq = rank*8 + file;
+            int sq = (7 - rank)*8 + file;
             // find which piece occupies this square
             int ptype = Em;
             for (int p = wP; p <= bK; ++p) {
@@ -126,18 +211,13 @@ std::string Position::get_fen() const {
     // 4) En passant
     oss << ' ';
     if (enpassant != no_sq) {
-        int f = enpassant % 8;
-        int r = enpassant / 8;
-        oss << char('a'+f) << char('1'+r);
+        oss << square_to_coordinates[enpassant];
     } else {
         oss << '-';
     }
 
-    // 5) Halfmove clock (if you track it, use that; else default to 0)
-    oss << " 0";
-
-    // 6) Fullmove number (if you track it, use that; else default to 1)
-    oss << " 1";
+    // 5) + 6) Move counters
+    oss << ' ' << halfmove << ' ' << fullmove;
 
     return oss.str();
 }
@@ -208,6 +288,8 @@ void Position::init() {
     castling   = wk | wq | bk | bq;      // All castling rights initially
     FiftyMove  = false;
     SideToMove = White;
+    halfmove   = 0;
+    fullmove   = 1;
 
     // Pawn ranks
     bitboards[bP] = 0x000000000000FF00ULL;  // white pawns on rank 2
@@ -235,6 +317,7 @@ void Position::init() {
 
     // If you have a compute_occupancies() helper, call it now:
     compute_occupancies();
+    hash_key = generate_hash_key(*this);
 }
 
 void Position::compute_occupancies() {
@@ -315,6 +398,20 @@ Position makemove(Move move, Position position){
     int enpassant = get_move_enpassant(move);
     int castling = get_move_castling(move);
 
+    // Incremental Zobrist update: mirror every bitboard change below
+    U64 key = position.hash_key;
+    key ^= Zobrist::keys.pieces[piece][source_square] ^ Zobrist::keys.pieces[piece][target_square];
+    if (enpassant) {
+        key ^= Zobrist::keys.pieces[capture][(position.SideToMove == White) ? target_square + 8 : target_square - 8];
+    } else if (capture != Em) {
+        key ^= Zobrist::keys.pieces[capture][target_square];
+    }
+    if (promoted && promoted != piece) {
+        key ^= Zobrist::keys.pieces[piece][target_square] ^ Zobrist::keys.pieces[promoted][target_square];
+    }
+    if (position.enpassant != no_sq) key ^= Zobrist::keys.enpassant[position.enpassant];
+    key ^= Zobrist::keys.castling[position.castling & 15];
+
     pop_bit(position.bitboards[piece], source_square);
     set_bit(position.bitboards[piece], target_square);
 
@@ -348,21 +445,25 @@ Position makemove(Move move, Position position){
             case g1:
                 pop_bit(position.bitboards[wR], h1);
                 set_bit(position.bitboards[wR], f1);
+                key ^= Zobrist::keys.pieces[wR][h1] ^ Zobrist::keys.pieces[wR][f1];
                 position.castling &= 0b1100;
                 break;
             case c1:
                 pop_bit(position.bitboards[wR], a1);
                 set_bit(position.bitboards[wR], d1);
+                key ^= Zobrist::keys.pieces[wR][a1] ^ Zobrist::keys.pieces[wR][d1];
                 position.castling &= 0b1100;
                 break;
             case g8:
                 pop_bit(position.bitboards[bR], h8);
                 set_bit(position.bitboards[bR], f8);
+                key ^= Zobrist::keys.pieces[bR][h8] ^ Zobrist::keys.pieces[bR][f8];
                 position.castling &= 0b0011;
                 break;
             case c8:
                 pop_bit(position.bitboards[bR], a8);
                 set_bit(position.bitboards[bR], d8);
+                key ^= Zobrist::keys.pieces[bR][a8] ^ Zobrist::keys.pieces[bR][d8];
                 position.castling &= 0b0011;
                 break;
         }
@@ -398,6 +499,15 @@ Position makemove(Move move, Position position){
 
     // 4) Only now do we switch sides
     position.SideToMove = them;
+
+    position.halfmove = (piece == wP || piece == bP || capture != Em) ? 0 : position.halfmove + 1;
+    if (us == Black) ++position.fullmove;
+    position.FiftyMove = position.halfmove >= 100;
+
+    if (position.enpassant != no_sq) key ^= Zobrist::keys.enpassant[position.enpassant];
+    key ^= Zobrist::keys.castling[position.castling & 15];
+    key ^= Zobrist::keys.side;
+    position.hash_key = key;
     return position;
 }
 
@@ -4,6 +4,7 @@
 #include <iostream>
 #include <cstring>
 #include <sstream>
+#include <string_view>
 #include "types.hpp"
 #include "bitboard.hpp"
 #include "nonmagic.hpp"
@@ -18,6 +19,9 @@ struct Position {
     U64 bitboards[12] = {0ULL};
     U64 occupancies[3] = {0ULL};
     uint8_t enpassant = no_sq;
+    U64 hash_key = 0ULL;     // Zobrist key, kept up to date by makemove
+    uint16_t halfmove = 0;   // plies since the last capture or pawn move
+    uint16_t fullmove = 1;   // starts at 1, incremented after Black moves
 
     Moves move_list;
 
@@ -33,6 +37,31 @@ struct Position {
     std::string get_fen() const;
 };
 
+// Why a FEN was rejected
+enum class FenError : uint8_t {
+    None,
+    Placement,      // bad piece letter, rank length or rank count
+    Kings,          // not exactly one king per side
+    SideToMove,
+    Castling,
+    EnPassant,
+    Halfmove,
+    Fullmove,
+    Trailing        // unexpected text after the last field
+};
+
+const char* fen_error_string(FenError error);
+
+// Parses `fen` into `position` without allocating. The half-move clock and
+// full-move number are optional (0 and 1 when missing; a full-move number
+// of 0, common in puzzle sources, reads as 1). With `consumed`
+// text after the fields is allowed (EPD operations) and *consumed is set to
+// where it starts; without it only whitespace may follow. On error the
+// contents of `position` are unspecified.
+FenError parse_fen(std::string_view fen, Position& position, size_t* consumed = nullptr);
+
+// Convenience wrapper: reports an invalid FEN on stderr and returns the
+// starting position instead
 Position parsefen(const std::string &fen);
 Position makemove(Move move, Position position);
 void FilterLegalMoves(Position& position);
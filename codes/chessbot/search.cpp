@@ -0,0 +1,575 @@
+#include "search.hpp"
+#include "position.hpp"
+#include "movedef.hpp"
+#include "attacks.hpp"
+#include "types.hpp"
+#include "tt.hpp"
+#include "uci.hpp"
+#include "bitbase.hpp"
+#include "mcts.hpp"
+#include "trace.hpp"
+#include <iostream>
+#include <climits>
+#include <algorithm>
+#include <chrono>
+#include <vector>
+#include <thread>
+#include <atomic>
+
+// Evaluator picked on the command line (--eval basic|pesto)
+EvaluatorType active_evaluator = EvaluatorType::Basic;
+
+// Alpha-beta unless --search mcts
+SearchAlgorithm active_search = SearchAlgorithm::AlphaBeta;
+
+// Lazy SMP: the main thread plus (search_threads - 1) helpers sharing the TT
+int search_threads = 1;
+
+// Root moves searched with an exact score each iteration
+int multi_pv = 1;
+
+// Deadlines and the stop flag shared by every search thread
+TimeManager time_manager;
+
+thread_local SearchContext search_context;
+
+void set_search_context(const SearchContext& context) {
+    search_context = context;
+    SearchStats::use_group(context.stats);
+}
+
+template<typename Evaluator>
+int Quiescence(Position pos, int alpha, int beta, int depth){
+    SearchStats::count_node();
+    STATS_INC(qnodes);
+    TRACE_NODE(Qsearch, depth, alpha, beta);
+    if (search_context.timer->poll()) TRACE_RETURN(Aborted, 0);
+
+    // Stand Pat
+    int best_value =  Evaluator::evaluate(pos);
+    if(depth > 8) {TRACE_RETURN(DepthLimit, best_value);} //Max_depth
+
+    if( best_value >= beta )
+        TRACE_RETURN(StandPat, best_value);
+    if( best_value > alpha )
+        alpha = best_value;
+
+    pos.generate_moves();
+    TRACE_SET(moves, pos.move_list.size());
+    if (pos.move_list.empty()) {
+        Color us   = pos.SideToMove;
+        Color them = (us == White ? Black : White);
+        int kingsq = get_ls1b_index(pos.bitboards[ us==White ? wK : bK ]);
+        // checkmate = large negative, stalemate = 0. On negamax's scale,
+        // -(MATE_SCORE + remaining depth): quiescence depth 1 sits at
+        // remaining depth 0, each level below it one ply further from the
+        // root, so uci_score can recover the mate distance
+        TRACE_RETURN(Terminal, isSquareAttacked(kingsq, pos, them)
+            ? -MATE_SCORE + (depth - 1)
+            : 0);
+    }
+
+    for(Move move : pos.move_list){
+        if(!get_move_capture_flag(move)) {continue;}
+            int score = -Quiescence<Evaluator>(makemove(move, pos), -beta, -alpha, depth + 1 );
+            if( score >= beta ) {
+                TRACE_SET(cutoff_index, std::count_if(pos.move_list.begin(),
+                    std::find(pos.move_list.begin(), pos.move_list.end(), move),
+                    [](Move other) { return get_move_capture_flag(other) != 0; }));
+                TRACE_SET(move, move);
+                TRACE_RETURN(BetaCutoff, score);
+            }
+            if( score > best_value )
+                best_value = score;
+            if( score > alpha )
+                alpha = score;
+    }
+    TRACE_RETURN(AllMoves, best_value);
+}
+
+// Use fixed-size arrays for better performance
+static constexpr int MAX_MOVES = 256;
+
+// Root move scores of the last completed iteration. Every search thread
+// keeps its own, so no locking is needed.
+struct RootOrdering {
+    std::pair<Move, int> scores[MAX_MOVES];
+    int count = 0;
+};
+
+// Custom comparator for move ordering
+struct MoveComparator {
+    bool operator()(const std::pair<Move, int>& a, const std::pair<Move, int>& b) const {
+        return a.second > b.second; // Higher scores first
+    }
+};
+
+void order_moves_by_previous_scores(Position& pos, const RootOrdering& ordering) {
+    if (ordering.count == 0) {
+        pos.order_moves();
+        return;
+    }
+    
+    Move ordered_moves[MAX_MOVES];
+    Move unscored_moves[MAX_MOVES];
+    int ordered_count = 0;
+    int unscored_count = 0;
+    
+    // First, add moves that were scored in previous iteration (in order)
+    for (int i = 0; i < ordering.count; ++i) {
+        Move scored_move = ordering.scores[i].first;
+        
+        for (size_t j = 0; j < pos.move_list.size(); ++j) {
+            if (pos.move_list[j] == scored_move) {
+                ordered_moves[ordered_count++] = scored_move;
+                break;
+            }
+        }
+    }
+    
+    // Add unscored moves
+    for (size_t i = 0; i < pos.move_list.size(); ++i) {
+        Move move = pos.move_list[i];
+        bool found = false;
+        
+        for (int j = 0; j < ordered_count; ++j) {
+            if (ordered_moves[j] == move) {
+                found = true;
+                break;
+            }
+        }
+        
+        if (!found) {
+            unscored_moves[unscored_count++] = move;
+        }
+    }
+    
+    // Combine moves
+    pos.move_list.clear();
+    pos.move_list.reserve(ordered_count + unscored_count);
+    
+    for (int i = 0; i < ordered_count; ++i) {
+        pos.move_list.push_back(ordered_moves[i]);
+    }
+    for (int i = 0; i < unscored_count; ++i) {
+        pos.move_list.push_back(unscored_moves[i]);
+    }
+}
+
+// Negamax with time checking. Once the stop flag is raised the returned
+// value is meaningless; Search_Position discards the unfinished iteration.
+template<typename Evaluator>
+int negamax(const Position& pos, int depth, int alpha, int beta) {
+    if (depth == 0) {
+        return Quiescence<Evaluator>(pos, alpha, beta, 1);
+    }
+
+    TranspositionTable& table = *search_context.table;
+    TimeManager& timer = *search_context.timer;
+
+    SearchStats::count_node();
+    TRACE_NODE(Search, depth, alpha, beta);
+    if (timer.poll()) TRACE_RETURN(Aborted, 0);
+
+    // Transposition table: cut off on a deep enough bound, else use its move first
+    const int alpha_orig = alpha;
+    Move tt_move = 0;
+    TTHit hit;
+    STATS_INC(tt_probes);
+    if (table.probe(pos.hash_key, hit)) {
+        STATS_INC(tt_hits);
+        TRACE_SET(tt_hit, 1);
+        tt_move = hit.move;
+        if (hit.depth >= depth) {
+            if (hit.flag == TT_EXACT) TRACE_RETURN(TTCutoff, hit.score);
+            if (hit.flag == TT_LOWER && hit.score >= beta) TRACE_RETURN(TTCutoff, beta);
+            if (hit.flag == TT_UPPER && hit.score <= alpha) TRACE_RETURN(TTCutoff, hit.score);
+        }
+    }
+
+    // Endgame bitbases: the result is known, the evaluation only ranks
+    // wins (and losses) among themselves
+    if (search_context.bitbase_pieces && count_bits(pos.occupancies[Both]) <= search_context.bitbase_pieces) {
+        Bitbase::WDL result;
+        if (Bitbase::probe(pos, result)) {
+            if (result == Bitbase::Draw) TRACE_RETURN(BitbaseHit, 0);
+            int eval = std::clamp(Evaluator::evaluate(pos), -2000, 2000);
+            TRACE_RETURN(BitbaseHit, result == Bitbase::Win ? BITBASE_WIN + eval : -BITBASE_WIN + eval);
+        }
+    }
+
+    Position search_pos = pos;
+    search_pos.generate_moves();
+    search_pos.order_moves();
+    TRACE_SET(moves, search_pos.move_list.size());
+    
+    if (search_pos.move_list.empty()) {
+        Color us = search_pos.SideToMove;
+        int kingsq = get_ls1b_index(search_pos.bitboards[us == White ? wK : bK]);
+        
+        TRACE_RETURN(Terminal, isSquareAttacked(kingsq, search_pos, us ^ 1)
+            ? (-MATE_SCORE - depth)
+            : 0);
+    }
+
+    if (tt_move) {
+        auto it = std::find(search_pos.move_list.begin(), search_pos.move_list.end(), tt_move);
+        if (it != search_pos.move_list.end()) std::rotate(search_pos.move_list.begin(), it, it + 1);
+    }
+
+    int best = -INT_MAX;
+    Move best_move = 0;
+    for (Move m : search_pos.move_list) {
+        Position nxt = makemove(m, search_pos);
+        int val = -negamax<Evaluator>(nxt, depth - 1, -beta, -alpha);
+        if (timer.stopped()) TRACE_RETURN(Aborted, 0);
+        
+        if (val >= beta) {
+            STATS_INC(beta_cutoffs);
+            if (m == search_pos.move_list.front()) STATS_INC(first_move_cutoffs);
+            table.store(pos.hash_key, depth, beta, TT_LOWER, m);
+            TRACE_SET(cutoff_index, std::find(search_pos.move_list.begin(), search_pos.move_list.end(), m)
+                                    - search_pos.move_list.begin());
+            TRACE_SET(move, m);
+            TRACE_RETURN(BetaCutoff, beta);
+        }
+        if (val > best) {
+            best = val;
+            best_move = m;
+        }
+        alpha = std::max(alpha, val);
+    }
+
+    if (best > alpha_orig) table.store(pos.hash_key, depth, best, TT_EXACT, best_move);
+    else                   table.store(pos.hash_key, depth, best, TT_UPPER, 0);
+    TRACE_SET(move, best_move);
+    TRACE_RETURN(AllMoves, best);
+}
+
+// Principal variation, read back from the transposition table
+std::vector<Move> extract_pv(Position pos, Move first, int max_length) {
+    std::vector<Move> pv;
+    if (!first) return pv;
+
+    const TranspositionTable& table = *search_context.table;
+    pv.push_back(first);
+    pos = makemove(first, pos);
+
+    TTHit hit;
+    while (static_cast<int>(pv.size()) < max_length && table.probe(pos.hash_key, hit) && hit.move) {
+        pos.generate_moves();
+        if (std::find(pos.move_list.begin(), pos.move_list.end(), hit.move) == pos.move_list.end()) break;
+        pv.push_back(hit.move);
+        pos = makemove(hit.move, pos);
+    }
+    return pv;
+}
+
+// UCI "score cp N" / "score mate N" from a root score at a given iteration depth
+std::string uci_score(int score, int depth) {
+    if (std::abs(score) >= MATE_SCORE - 1000) {
+        // Mated nodes score -(MATE_SCORE + remaining depth), quiescence
+        // nodes counting as negative remaining depth
+        int plies = std::max(1, depth - (std::abs(score) - MATE_SCORE));
+        int moves = (plies + 1) / 2;
+        return "mate " + std::to_string(score > 0 ? moves : -moves);
+    }
+    return "cp " + std::to_string(score);
+}
+
+static void print_uci_info(const Position& root, int depth, int multipv, int score, Move best_move) {
+    const TimeManager& timer = *search_context.timer;
+    const TranspositionTable& table = *search_context.table;
+    int64_t elapsed = timer.elapsed_ms();
+    uint64_t nodes = SearchStats::get_positions_searched();
+    uint64_t nps = elapsed > 0 ? nodes * 1000 / elapsed : nodes;
+
+    std::cout << "info depth " << depth
+              << " multipv " << multipv
+              << " score " << uci_score(score, depth)
+              << " nodes " << nodes
+              << " nps " << nps
+              << " time " << elapsed
+              << " hashfull " << table.hashfull()
+              << " pv";
+    for (Move m : extract_pv(root, best_move, depth)) std::cout << ' ' << move_to_uci(m);
+    std::cout << std::endl;
+}
+
+// Lazy SMP helper: same iterative deepening, no reporting. Helpers start on
+// alternating depths and at a rotated root move so they fill the shared TT
+// with different subtrees ahead of the main thread.
+template<typename Evaluator>
+static void helper_search(Position root, int max_depth, int thread_id, SearchContext context) {
+    set_search_context(context);
+    SearchStats::bind_thread(thread_id);
+    TimeManager& timer = *context.timer;
+    const size_t n = root.move_list.size();
+    for (int depth = 1 + (thread_id & 1); depth <= max_depth; ++depth) {
+        for (size_t k = 0; k < n; ++k) {
+            Position nxt = makemove(root.move_list[(k + thread_id) % n], root);
+            negamax<Evaluator>(nxt, depth - 1, -INT_MAX, INT_MAX);
+            if (timer.stopped()) return;
+        }
+    }
+}
+
+template<typename Evaluator>
+Move Search_Position(Position pos, const SearchLimits& limits, SearchOutput output, std::vector<PVLine>* lines) {
+    const bool verbose = (output == SearchOutput::Human);
+    const bool uci = (output == SearchOutput::Uci);
+    TranspositionTable& table = *search_context.table;
+    TimeManager& timer = *search_context.timer;
+
+    SearchStats::bind_thread(0);
+    SearchStats::reset_counters();
+    if (lines) lines->clear();
+    
+    pos.generate_moves();
+    if (pos.move_list.empty()) return 0;
+    
+    Move best_move = pos.move_list[0];
+    int best_score = -INT_MAX;
+    RootOrdering ordering;
+    const int pv_count = std::clamp(active_multi_pv(), 1, static_cast<int>(pos.move_list.size()));
+    
+    // Probe the bitbases below the root's material only: in a position
+    // already covered, every move would keep the same result and the
+    // search would drift instead of making progress towards mate
+    search_context.bitbase_pieces = std::min(Bitbase::max_pieces, count_bits(pos.occupancies[Both]) - 1);
+
+    // Initialize time control
+    timer.start(limits, pos.SideToMove);
+    int max_depth = limits.depth > 0 ? std::min(limits.depth, MAX_DEPTH) : MAX_DEPTH;
+
+    // Nothing to think about when the clock is running and the move is forced
+    if (pos.move_list.size() == 1 && timer.is_time_managed()) {
+        if (verbose) std::cout << "Only one legal move." << std::endl;
+        if (lines) lines->push_back({best_move, 0, {best_move}});
+        SearchStats::finish();
+        return best_move;
+    }
+    
+    if (verbose && timer.is_time_managed()) {
+        std::cout << "Starting search (soft " << timer.soft_limit_ms()
+                  << "ms, hard " << timer.hard_limit_ms() << "ms)..." << std::endl;
+    }
+
+    std::vector<std::thread> helpers;
+    for (int t = 1; t < search_threads; ++t) {
+        helpers.emplace_back(helper_search<Evaluator>, pos, max_depth, t, search_context);
+    }
+    
+    // Iterative deepening; the hard limit is enforced inside the tree by
+    // node-count polling, the soft limit between iterations
+    for (int current_depth = 1; current_depth <= max_depth; ++current_depth) {
+        if (verbose) std::cout << "Searching depth " << current_depth << "..." << std::endl;
+        TRACE_ITERATION(current_depth);
+        
+        // Order moves based on previous iteration scores
+        order_moves_by_previous_scores(pos, ordering);
+        
+        std::pair<Move, int> current_move_scores[MAX_MOVES];
+        int current_score_count = 0;
+        bool depth_completed = true;
+
+        // Best pv_count moves so far, best first. A move only has to beat the
+        // last of them, so once the slots are full every other root move is
+        // searched with that score as alpha and fails low cheaply.
+        std::pair<Move, int> top[MAX_MOVES];
+        int top_count = 0;
+        
+        // Search all moves at current depth
+        for (size_t i = 0; i < pos.move_list.size(); ++i) {
+            Move m = pos.move_list[i];
+            Position nxt = makemove(m, pos);
+            int alpha = top_count < pv_count ? -INT_MAX : top[top_count - 1].second;
+            int score = -negamax<Evaluator>(nxt, current_depth - 1, -INT_MAX, -alpha);
+            
+            // A stopped subtree returns garbage: drop the whole iteration
+            if (timer.stopped()) {
+                if (verbose) std::cout << "Search stopped during depth " << current_depth
+                                       << " after " << i << " moves" << std::endl;
+                depth_completed = false;
+                break;
+            }
+
+            // Fail-lows keep their bound: still good enough to order by
+            current_move_scores[current_score_count++] = {m, score};
+            if (score <= alpha) continue;
+
+            int slot = std::min(top_count, pv_count - 1);
+            while (slot > 0 && top[slot - 1].second < score) {
+                top[slot] = top[slot - 1];
+                --slot;
+            }
+            top[slot] = {m, score};
+            top_count = std::min(top_count + 1, pv_count);
+            
+            // Early termination for mate
+            if (pv_count == 1 && score >= MATE_SCORE - 1000) {
+                if (verbose) std::cout << "Mate found at depth " << current_depth << "!" << std::endl;
+                best_move = m;
+                best_score = score;
+                table.store(pos.hash_key, current_depth, best_score, TT_EXACT, best_move);
+                SearchStats::record_depth(current_depth);
+                if (uci) print_uci_info(pos, current_depth, 1, best_score, best_move);
+                if (lines) *lines = {{m, score, extract_pv(pos, m, current_depth)}};
+                goto search_complete;
+            }
+        }
+        
+        // Only update best move if we completed the depth
+        if (!depth_completed || top_count == 0) break;
+
+        best_move = top[0].first;
+        best_score = top[0].second;
+        table.store(pos.hash_key, current_depth, best_score, TT_EXACT, best_move);
+        SearchStats::record_depth(current_depth);
+        
+        if (verbose) std::cout << "Depth " << current_depth << " completed in " << timer.elapsed_ms()
+                               << "ms, best: " << square_to_coordinates[get_move_source(best_move)]
+                               << square_to_coordinates[get_move_target(best_move)]
+                               << " (score: " << best_score << ")" << std::endl;
+        for (int k = 0; k < top_count; ++k) {
+            if (verbose && pv_count > 1) {
+                std::cout << "  " << k + 1 << ". " << move_to_uci(top[k].first)
+                          << " (score: " << top[k].second << ")" << std::endl;
+            }
+            if (uci) print_uci_info(pos, current_depth, k + 1, top[k].second, top[k].first);
+        }
+        if (lines) {
+            lines->clear();
+            for (int k = 0; k < top_count; ++k) {
+                lines->push_back({top[k].first, top[k].second, extract_pv(pos, top[k].first, current_depth)});
+            }
+        }
+        
+        // Store move scores for next iteration ordering
+        ordering.count = std::min(current_score_count, MAX_MOVES);
+        for (int i = 0; i < ordering.count; ++i) {
+            ordering.scores[i] = current_move_scores[i];
+        }
+        std::stable_sort(ordering.scores, ordering.scores + ordering.count, MoveComparator());
+        
+        // Soft limit, scaled by best-move stability
+        if (timer.iteration_done(best_move)) {
+            if (verbose) std::cout << "Time budget reached after depth " << current_depth << std::endl;
+            break;
+        }
+    }
+    
+    search_complete:
+    // Release the helpers
+    timer.stop_now();
+    for (std::thread& helper : helpers) helper.join();
+    SearchStats::finish();
+    TRACE_FLUSH();
+
+    if (verbose) std::cout << "Search completed in " << SearchStats::get_search_time_ms() << "ms, positions: "
+                           << SearchStats::get_positions_searched() << std::endl;
+    if (SearchStats::enabled) {
+        if (uci) SearchStats::print_uci(SearchStats::collect());
+        if (verbose) std::cout << SearchStats::to_json(SearchStats::collect()) << std::endl;
+    }
+    
+    return best_move;
+}
+
+template<typename Evaluator>
+Move findbestmove(Position position, const SearchLimits& limits, SearchOutput output, std::vector<PVLine>* lines) {
+    if (active_search == SearchAlgorithm::Mcts) return Mcts::search<Evaluator>(position, limits, output, lines);
+    return Search_Position<Evaluator>(position, limits, output, lines);
+}
+
+Move findbestmove(EvaluatorType evaluator, Position position, const SearchLimits& limits,
+                  SearchOutput output, std::vector<PVLine>* lines) {
+    switch (evaluator) {
+        case EvaluatorType::Pesto: return findbestmove<PestoEvaluator>(position, limits, output, lines);
+        case EvaluatorType::Basic:
+        default:                   return findbestmove<BasicEvaluator>(position, limits, output, lines);
+    }
+}
+
+Move findbestmove(Position position, const SearchLimits& limits, SearchOutput output, std::vector<PVLine>* lines) {
+    return findbestmove(active_evaluator, position, limits, output, lines);
+}
+
+Move findbestmove(Position position) {
+    // No clock available: fall back to a fixed time per move
+    SearchLimits limits;
+    limits.movetime = 2500;
+    return findbestmove(position, limits);
+}
+
+// Constructor implementations
+SearchResult::SearchResult() : move(0), score(-INT_MAX) {}
+SearchResult::SearchResult(Move m, int s) : move(m), score(s) {}
+
+// ThreadedSearch constructor
+ThreadedSearch::ThreadedSearch() : 
+    global_best_move{0}, 
+    global_best_score{-INT_MAX}, 
+    search_stopped{false}, 
+    mate_found{false} {}
+
+template<typename Evaluator>
+SearchResult ThreadedSearch::search_move(const Position& pos, Move move, int depth, int alpha, int beta) {
+    if (search_stopped.load(std::memory_order_relaxed)) {
+        return SearchResult(move, -INT_MAX);
+    }
+    
+    Position nxt = makemove(move, pos);
+    int score = -negamax<Evaluator>(nxt, depth - 1, -beta, -alpha);
+    
+    // Early termination for mate
+    if (score >= MATE_SCORE - 1000) {
+        mate_found.store(true, std::memory_order_relaxed);
+        search_stopped.store(true, std::memory_order_relaxed);
+    }
+    
+    return SearchResult(move, score);
+}
+
+void ThreadedSearch::update_best_move(const SearchResult& result) {
+    int current_best = global_best_score.load(std::memory_order_relaxed);
+    while (result.score > current_best && 
+           !global_best_score.compare_exchange_weak(current_best, result.score, std::memory_order_relaxed)) {
+        // Retry if another thread updated the score
+    }
+    if (result.score > current_best) {
+        global_best_move.store(result.move, std::memory_order_relaxed);
+    }
+}
+
+Move ThreadedSearch::get_best_move() const { 
+    return global_best_move.load(std::memory_order_relaxed); 
+}
+
+int ThreadedSearch::get_best_score() const { 
+    return global_best_score.load(std::memory_order_relaxed); 
+}
+
+void ThreadedSearch::stop_search() { 
+    search_stopped.store(true, std::memory_order_relaxed); 
+}
+
+bool ThreadedSearch::is_mate_found() const { 
+    return mate_found.load(std::memory_order_relaxed); 
+}
+
+//----------------------------------------------------------------------
+// Explicit instantiations: one search per evaluator policy
+//----------------------------------------------------------------------
+
+#define INSTANTIATE_SEARCH(Evaluator) \
+    template int Quiescence<Evaluator>(Position, int, int, int); \
+    template int negamax<Evaluator>(const Position&, int, int, int); \
+    template Move Search_Position<Evaluator>(Position, const SearchLimits&, SearchOutput, std::vector<PVLine>*); \
+    template Move findbestmove<Evaluator>(Position, const SearchLimits&, SearchOutput, std::vector<PVLine>*); \
+    template SearchResult ThreadedSearch::search_move<Evaluator>(const Position&, Move, int, int, int);
+
+INSTANTIATE_SEARCH(BasicEvaluator)
+INSTANTIATE_SEARCH(PestoEvaluator)
+
+#undef INSTANTIATE_SEARCH
@@ -0,0 +1,151 @@
+#ifndef SEARCH_HPP
+#define SEARCH_HPP
+
+#include <atomic>
+#include <string>
+#include <vector>
+#include "position.hpp"
+#include "movedef.hpp"
+#include "types.hpp"
+#include "timeman.hpp"
+#include "stats.hpp"
+#include "tt.hpp"
+#include "Evaluation/evaluator.hpp"
+
+// Forward declarations for optimization
+struct SearchResult;
+class ThreadedSearch;
+namespace Mcts { class Tree; }
+
+// Evaluator used by the non-template findbestmove (set from the command line)
+extern EvaluatorType active_evaluator;
+
+// Tree search run by findbestmove (--search, UCI option "SearchAlgorithm")
+enum class SearchAlgorithm {
+    AlphaBeta,
+    Mcts
+};
+
+extern SearchAlgorithm active_search;
+
+inline const char* search_algorithm_name(SearchAlgorithm algorithm) {
+    return algorithm == SearchAlgorithm::Mcts ? "mcts" : "alphabeta";
+}
+
+// Returns false if `name` is not a known search algorithm
+inline bool parse_search_algorithm(const std::string& name, SearchAlgorithm& algorithm) {
+    if (name == "alphabeta") { algorithm = SearchAlgorithm::AlphaBeta; return true; }
+    if (name == "mcts")      { algorithm = SearchAlgorithm::Mcts; return true; }
+    return false;
+}
+
+// Deadlines and stop flag of the running search
+extern TimeManager time_manager;
+
+// What a search reads and writes besides its position. Every thread uses
+// the global table, time manager and statistics unless it installs its own
+// context, as batch tools running independent searches side by side do.
+// Lazy SMP helpers inherit the context of the thread that spawned them.
+struct SearchContext {
+    TranspositionTable* table = &tt;
+    TimeManager* timer = &time_manager;
+    SearchStats::Group* stats = &SearchStats::global_group;
+    int bitbase_pieces = 0;     // probe limit, set by Search_Position for its tree
+    Mcts::Tree* tree = nullptr; // MCTS tree kept between moves; one per thread when null
+    int multi_pv = 0;           // root moves to report; 0 uses the global multi_pv
+};
+
+extern thread_local SearchContext search_context;
+void set_search_context(const SearchContext& context);
+
+// Number of threads used by Search_Position (UCI option "Threads")
+extern int search_threads;
+
+// Number of root moves reported with exact scores (UCI option "MultiPV")
+extern int multi_pv;
+
+// MultiPV of the calling thread's search: its context's, else the global one
+inline int active_multi_pv() {
+    return search_context.multi_pv > 0 ? search_context.multi_pv : multi_pv;
+}
+
+// What Search_Position prints while it runs
+enum class SearchOutput {
+    Silent,     // nothing (bench, batch tools)
+    Human,      // progress lines for the interactive modes
+    Uci         // "info ..." lines
+};
+
+// One line of a MultiPV report: a root move, its score and its PV
+struct PVLine {
+    Move move;
+    int score;
+    std::vector<Move> pv;
+};
+
+// Search functions, instantiated in search.cpp for every evaluator policy
+template<typename Evaluator>
+int Quiescence(Position pos, int alpha, int beta, int depth);
+template<typename Evaluator>
+int negamax(const Position& pos, int depth, int alpha, int beta);
+
+// Main search interface. When `lines` is given it receives the best
+// multi_pv lines of the last completed iteration, best first.
+template<typename Evaluator>
+Move Search_Position(Position pos, const SearchLimits& limits, SearchOutput output = SearchOutput::Human,
+                     std::vector<PVLine>* lines = nullptr);
+template<typename Evaluator>
+Move findbestmove(Position position, const SearchLimits& limits, SearchOutput output = SearchOutput::Human,
+                  std::vector<PVLine>* lines = nullptr);
+
+// Dispatches once on the evaluator, then runs the matching instantiation
+Move findbestmove(EvaluatorType evaluator, Position position, const SearchLimits& limits,
+                  SearchOutput output = SearchOutput::Human, std::vector<PVLine>* lines = nullptr);
+// Same, with active_evaluator
+Move findbestmove(Position position, const SearchLimits& limits, SearchOutput output = SearchOutput::Human,
+                  std::vector<PVLine>* lines = nullptr);
+// Same, with a fixed 2.5 s per move for callers that have no clock
+Move findbestmove(Position position);
+
+// Principal variation read back from the transposition table
+std::vector<Move> extract_pv(Position pos, Move first, int max_length);
+// "cp N" or "mate N" for a root score found at the given iteration depth
+std::string uci_score(int score, int depth);
+
+// Search result structure for threading
+struct SearchResult {
+    Move move;
+    int score;
+
+    SearchResult();
+    SearchResult(Move m, int s);
+};
+
+// Threaded search class for parallel processing
+class ThreadedSearch {
+private:
+    std::atomic<Move> global_best_move;
+    std::atomic<int> global_best_score;
+    std::atomic<bool> search_stopped;
+    std::atomic<bool> mate_found;
+
+public:
+    ThreadedSearch();
+
+    template<typename Evaluator>
+    SearchResult search_move(const Position& pos, Move move, int depth, int alpha, int beta);
+    void update_best_move(const SearchResult& result);
+
+    Move get_best_move() const;
+    int get_best_score() const;
+    void stop_search();
+    bool is_mate_found() const;
+};
+
+// Optimization constants
+static constexpr int MATE_SCORE = 200000;
+static constexpr int BITBASE_WIN = 50000;   // known win, ranked below any mate
+static constexpr int MAX_QUIESCENCE_DEPTH = 6;
+static constexpr int MAX_DEPTH = 64;
+
+#endif // SEARCH_HPP
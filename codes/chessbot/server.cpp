@@ -0,0 +1,589 @@
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <condition_variable>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <iomanip>
+#include <iostream>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <string_view>
+#include <thread>
+#include <unordered_map>
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include "server.hpp"
+#include "position.hpp"
+#include "search.hpp"
+#include "tt.hpp"
+#include "uci.hpp"
+
+namespace {
+
+constexpr size_t MAX_REQUEST_BYTES = 64 * 1024;
+constexpr int MAX_MULTI_PV = 64;
+
+//----------------------------------------------------------------------
+// Requests: one flat JSON object per line, string / number / true /
+// false / null values only
+//----------------------------------------------------------------------
+
+struct JsonValue {
+    bool is_string = false;
+    std::string text;       // unescaped string, or the literal as written
+};
+
+using JsonObject = std::unordered_map<std::string, JsonValue>;
+
+std::string json_escape(std::string_view text) {
+    std::string out;
+    for (char c : text) {
+        if (c == '"' || c == '\\') out += '\\';
+        if (c == '\n') out += "\\n";
+        else if (static_cast<unsigned char>(c) >= 0x20) out += c;
+    }
+    return out;
+}
+
+void skip_space(std::string_view text, size_t& at) {
+    while (at < text.size() && (text[at] == ' ' || text[at] == '\t' || text[at] == '\r' || text[at] == '\n')) ++at;
+}
+
+bool parse_string(std::string_view text, size_t& at, std::string& out) {
+    if (at >= text.size() || text[at] != '"') return false;
+    for (++at; at < text.size(); ++at) {
+        char c = text[at];
+        if (c == '"') {
+            ++at;
+            return true;
+        }
+        if (c != '\\') {
+            out += c;
+            continue;
+        }
+        if (++at >= text.size()) return false;
+        switch (text[at]) {
+            case 'n': out += '\n'; break;
+            case 't': out += '\t'; break;
+            case 'r': out += '\r'; break;
+            case 'b': out += '\b'; break;
+            case 'f': out += '\f'; break;
+            case 'u':
+                // FENs and ids are ASCII; anything wider is kept as '?'
+                if (at + 4 >= text.size()) return false;
+                {
+                    unsigned code = std::strtoul(std::string(text.substr(at + 1, 4)).c_str(), nullptr, 16);
+                    out += code < 0x80 ? static_cast<char>(code) : '?';
+                }
+                at += 4;
+                break;
+            default: out += text[at]; break;     // \" \\ \/
+        }
+    }
+    return false;
+}
+
+bool parse_request(std::string_view text, JsonObject& object) {
+    size_t at = 0;
+    skip_space(text, at);
+    if (at >= text.size() || text[at++] != '{') return false;
+    skip_space(text, at);
+    if (at < text.size() && text[at] == '}') return true;
+
+    for (;;) {
+        std::string key;
+        skip_space(text, at);
+        if (!parse_string(text, at, key)) return false;
+        skip_space(text, at);
+        if (at >= text.size() || text[at++] != ':') return false;
+        skip_space(text, at);
+
+        JsonValue value;
+        if (at < text.size() && text[at] == '"') {
+            value.is_string = true;
+            if (!parse_string(text, at, value.text)) return false;
+        } else {
+            size_t end = at;
+            while (end < text.size() && text[end] != ',' && text[end] != '}' && text[end] != ' ') ++end;
+            value.text = std::string(text.substr(at, end - at));
+            const std::string& literal = value.text;
+            char* number_end = nullptr;
+            std::strtod(literal.c_str(), &number_end);
+            bool number = !literal.empty() && *number_end == '\0';
+            if (!number && literal != "true" && literal != "false" && literal != "null") return false;
+            at = end;
+        }
+        object[key] = value;
+
+        skip_space(text, at);
+        if (at >= text.size()) return false;
+        char c = text[at++];
+        if (c == '}') return true;
+        if (c != ',') return false;
+    }
+}
+
+std::string json_value(const JsonValue& value) {
+    return value.is_string ? "\"" + json_escape(value.text) + "\"" : value.text;
+}
+
+//----------------------------------------------------------------------
+// Connections, jobs, cache
+//----------------------------------------------------------------------
+
+// A client socket; replies from workers and from the reader interleave
+// whole lines only
+struct Connection {
+    explicit Connection(int descriptor) : fd(descriptor) {}
+    ~Connection() { ::close(fd); }
+
+    void send_line(const std::string& line) {
+        std::lock_guard<std::mutex> lk(write_lock);
+        std::string data = line + "\n";
+        size_t sent = 0;
+        while (sent < data.size()) {
+            ssize_t n = ::send(fd, data.data() + sent, data.size() - sent, MSG_NOSIGNAL);
+            if (n <= 0) return;     // client gone: its answers are dropped
+            sent += static_cast<size_t>(n);
+        }
+    }
+
+    const int fd;
+    std::mutex write_lock;
+};
+
+struct Job {
+    std::shared_ptr<Connection> connection;
+    std::string id;             // JSON text of the request id, empty when none
+    Position position;
+    SearchLimits limits;
+    int multi_pv = 1;
+    std::string cache_key;
+};
+
+class JobQueue {
+public:
+    void push(Job job) {
+        {
+            std::lock_guard<std::mutex> lk(lock);
+            jobs.push_back(std::move(job));
+        }
+        ready.notify_one();
+    }
+
+    // False once the queue is closed and drained
+    bool pop(Job& job) {
+        std::unique_lock<std::mutex> lk(lock);
+        ready.wait(lk, [this] { return closed || !jobs.empty(); });
+        if (jobs.empty()) return false;
+        job = std::move(jobs.front());
+        jobs.pop_front();
+        return true;
+    }
+
+    void close() {
+        {
+            std::lock_guard<std::mutex> lk(lock);
+            closed = true;
+            jobs.clear();
+        }
+        ready.notify_all();
+    }
+
+    size_t size() {
+        std::lock_guard<std::mutex> lk(lock);
+        return jobs.size();
+    }
+
+private:
+    std::mutex lock;
+    std::condition_variable ready;
+    std::deque<Job> jobs;
+    bool closed = false;
+};
+
+// Least recently used map from request key to the answer's JSON fields
+// (all but the id and the FEN, which come from the request)
+class ResultCache {
+public:
+    explicit ResultCache(size_t entries) : capacity(entries) {}
+
+    bool get(const std::string& key, std::string& body) {
+        std::lock_guard<std::mutex> lk(lock);
+        auto it = index.find(key);
+        if (it == index.end()) return false;
+        order.splice(order.begin(), order, it->second);
+        body = it->second->second;
+        return true;
+    }
+
+    void put(const std::string& key, const std::string& body) {
+        if (capacity == 0) return;
+        std::lock_guard<std::mutex> lk(lock);
+        auto it = index.find(key);
+        if (it != index.end()) {
+            it->second->second = body;
+            order.splice(order.begin(), order, it->second);
+            return;
+        }
+        order.emplace_front(key, body);
+        index[key] = order.begin();
+        if (order.size() > capacity) {
+            index.erase(order.back().first);
+            order.pop_back();
+        }
+    }
+
+    size_t size() {
+        std::lock_guard<std::mutex> lk(lock);
+        return order.size();
+    }
+
+private:
+    size_t capacity;
+    std::mutex lock;
+    std::list<std::pair<std::string, std::string>> order;     // most recent first
+    std::unordered_map<std::string, std::list<std::pair<std::string, std::string>>::iterator> index;
+};
+
+struct Server {
+    Server(size_t hash_mb, size_t cache_entries, int worker_count)
+        : table(hash_mb), cache(cache_entries), timers(worker_count) {}
+
+    TranspositionTable table;
+    ResultCache cache;
+    JobQueue queue;
+    std::vector<TimeManager> timers;    // one per worker, stopped on shutdown
+    std::atomic<bool> shutting_down{false};
+
+    std::atomic<uint64_t> requests{0};
+    std::atomic<uint64_t> cache_hits{0};
+    std::atomic<uint64_t> searches{0};
+    std::atomic<uint64_t> errors{0};
+
+    // One per open client. A reader raises `done` as it returns and is
+    // joined and dropped by the accept loop, so short-lived clients do
+    // not pile up threads; the socket itself closes with the last
+    // shared_ptr (the reader's or a queued job's).
+    struct Reader {
+        std::thread thread;
+        std::shared_ptr<std::atomic<bool>> done;
+        std::weak_ptr<Connection> connection;
+    };
+    std::vector<Reader> readers;     // accept loop only
+};
+
+std::string reply_prefix(const std::string& id) {
+    return id.empty() ? "{" : "{\"id\": " + id + ", ";
+}
+
+void reply_error(Server& server, Connection& connection, const std::string& id, const std::string& message) {
+    server.errors += 1;
+    connection.send_line(reply_prefix(id) + "\"error\": \"" + json_escape(message) + "\"}");
+}
+
+// Same position, limits and MultiPV: same answer. The move counters
+// are left out, they do not change the search.
+std::string cache_key(const Position& position, const SearchLimits& limits, int multi_pv) {
+    std::string fen = position.get_fen();
+    size_t cut = fen.size();
+    for (int spaces = 0; cut > 0 && spaces < 2; --cut)
+        if (fen[cut - 1] == ' ') ++spaces;
+    std::ostringstream key;
+    key << fen.substr(0, cut) << '|' << limits.depth << '|' << limits.nodes << '|' << limits.movetime << '|' << multi_pv;
+    return key.str();
+}
+
+// Integer field of a request: false when present but not a number
+bool int_field(const JsonObject& request, const char* name, long long& value) {
+    auto it = request.find(name);
+    if (it == request.end() || it->second.text == "null") return true;
+    if (it->second.is_string) return false;
+    char* end = nullptr;
+    value = std::strtoll(it->second.text.c_str(), &end, 10);
+    return *end == '\0' && value >= 0;
+}
+
+void handle_request(Server& server, const std::shared_ptr<Connection>& connection, std::string_view line) {
+    server.requests += 1;
+    JsonObject request;
+    if (!parse_request(line, request)) {
+        reply_error(server, *connection, "", "malformed request");
+        return;
+    }
+    auto id_field = request.find("id");
+    std::string id = id_field == request.end() ? "" : json_value(id_field->second);
+
+    auto cmd = request.find("cmd");
+    if (cmd != request.end()) {
+        if (cmd->second.text == "stats") {
+            std::ostringstream out;
+            out << reply_prefix(id) << "\"requests\": " << server.requests << ", \"searches\": " << server.searches
+                << ", \"cache_hits\": " << server.cache_hits << ", \"errors\": " << server.errors
+                << ", \"cached\": " << server.cache.size() << ", \"queued\": " << server.queue.size()
+                << ", \"hashfull\": " << server.table.hashfull() << "}";
+            connection->send_line(out.str());
+        } else if (cmd->second.text == "shutdown") {
+            connection->send_line(reply_prefix(id) + "\"shutdown\": true}");
+            server.shutting_down = true;
+        } else {
+            reply_error(server, *connection, id, "unknown cmd " + cmd->second.text);
+        }
+        return;
+    }
+
+    Job job;
+    job.connection = connection;
+    job.id = id;
+
+    auto fen = request.find("fen");
+    if (fen == request.end() || !fen->second.is_string) {
+        reply_error(server, *connection, id, "missing fen");
+        return;
+    }
+    FenError error = parse_fen(fen->second.text, job.position);
+    if (error != FenError::None) {
+        reply_error(server, *connection, id, std::string("invalid fen (") + fen_error_string(error) + ")");
+        return;
+    }
+
+    long long depth = 0, nodes = 0, movetime = 0, multi_pv = 1;
+    if (!int_field(request, "depth", depth) || !int_field(request, "nodes", nodes)
+        || !int_field(request, "movetime", movetime) || !int_field(request, "multipv", multi_pv)) {
+        reply_error(server, *connection, id, "limits must be non-negative integers");
+        return;
+    }
+    if (depth == 0 && nodes == 0 && movetime == 0) {
+        reply_error(server, *connection, id, "a depth, nodes or movetime limit is required");
+        return;
+    }
+    job.limits.depth = static_cast<int>(std::min<long long>(depth, MAX_DEPTH));
+    job.limits.nodes = static_cast<uint64_t>(nodes);
+    job.limits.movetime = static_cast<int>(std::min<long long>(movetime, 24LL * 3600 * 1000));
+    job.multi_pv = static_cast<int>(std::clamp<long long>(multi_pv, 1, MAX_MULTI_PV));
+    job.cache_key = cache_key(job.position, job.limits, job.multi_pv);
+
+    std::string body;
+    if (server.cache.get(job.cache_key, body)) {
+        server.cache_hits += 1;
+        connection->send_line(reply_prefix(id) + "\"fen\": \"" + job.position.get_fen() + "\", \"cached\": true, "
+                              + body + "}");
+        return;
+    }
+    server.queue.push(std::move(job));
+}
+
+// Reads newline separated requests until the client closes
+void read_requests(Server& server, const std::shared_ptr<Connection>& connection) {
+    std::string pending;
+    char chunk[4096];
+    for (;;) {
+        ssize_t n = ::recv(connection->fd, chunk, sizeof(chunk), 0);
+        if (n <= 0) break;
+        pending.append(chunk, static_cast<size_t>(n));
+
+        size_t start = 0;
+        for (size_t end; (end = pending.find('\n', start)) != std::string::npos; start = end + 1) {
+            std::string_view line(pending.data() + start, end - start);
+            if (line.find_first_not_of(" \t\r") != std::string_view::npos) handle_request(server, connection, line);
+        }
+        pending.erase(0, start);
+        if (pending.size() > MAX_REQUEST_BYTES) {
+            reply_error(server, *connection, "", "request too long");
+            break;
+        }
+    }
+}
+
+// Reader thread of one client
+void connection_reader(Server& server, std::shared_ptr<Connection> connection,
+                       std::shared_ptr<std::atomic<bool>> done) {
+    read_requests(server, connection);
+    connection.reset();     // the socket closes now unless jobs still hold it
+    done->store(true);
+}
+
+// Joins the readers whose clients are gone
+void reap_readers(Server& server) {
+    for (size_t i = 0; i < server.readers.size();) {
+        if (!server.readers[i].done->load()) {
+            ++i;
+            continue;
+        }
+        server.readers[i].thread.join();
+        if (i + 1 < server.readers.size()) server.readers[i] = std::move(server.readers.back());
+        server.readers.pop_back();
+    }
+}
+
+std::string search_body(Move best, const std::vector<PVLine>& lines,
+                        const SearchStats::Totals& searched) {
+    int depth = searched.depths.empty() ? 0 : searched.depths.back().depth;
+    std::ostringstream out;
+    out << "\"bestmove\": \"" << move_to_uci(best) << "\""
+        << ", \"score\": \"" << uci_score(lines.empty() ? 0 : lines.front().score, depth) << "\""
+        << ", \"depth\": " << depth
+        << ", \"nodes\": " << searched.nodes
+        << ", \"time_ms\": " << std::fixed << std::setprecision(1) << searched.time_ms
+        << ", \"lines\": [";
+    for (size_t k = 0; k < lines.size(); ++k) {
+        out << (k ? ", " : "") << "{\"move\": \"" << move_to_uci(lines[k].move) << "\""
+            << ", \"score\": \"" << uci_score(lines[k].score, depth) << "\", \"pv\": [";
+        for (size_t i = 0; i < lines[k].pv.size(); ++i)
+            out << (i ? ", " : "") << "\"" << move_to_uci(lines[k].pv[i]) << "\"";
+        out << "]}";
+    }
+    out << "]";
+    return out.str();
+}
+
+void search_worker(Server& server, int id) {
+    TimeManager& timer = server.timers[id];
+    auto stats = std::make_unique<SearchStats::Group>();
+    SearchContext context{&server.table, &timer, stats.get()};
+
+    Job job;
+    while (server.queue.pop(job)) {
+        context.multi_pv = job.multi_pv;
+        set_search_context(context);
+
+        std::vector<PVLine> lines;
+        Move best = findbestmove(job.position, job.limits, SearchOutput::Silent, &lines);
+        SearchStats::Totals searched = SearchStats::collect();
+        server.searches += 1;
+        if (timer.is_stop_requested()) break;     // cut short by shutdown: not an answer
+
+        std::string body = search_body(best, lines, searched);
+        server.cache.put(job.cache_key, body);
+        job.connection->send_line(reply_prefix(job.id) + "\"fen\": \"" + job.position.get_fen()
+                                  + "\", \"cached\": false, " + body + "}");
+        job.connection.reset();
+    }
+}
+
+int listen_unix(const std::string& path) {
+    sockaddr_un address{};
+    if (path.size() >= sizeof(address.sun_path)) return -1;
+    int fd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0) return -1;
+    address.sun_family = AF_UNIX;
+    std::strncpy(address.sun_path, path.c_str(), sizeof(address.sun_path) - 1);
+    ::unlink(path.c_str());     // a stale socket from an earlier run
+    if (::bind(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0 || ::listen(fd, 64) != 0) {
+        ::close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+// Loopback only: the server is for tools on this machine
+int listen_tcp(int port) {
+    int fd = ::socket(AF_INET, SOCK_STREAM, 0);
+    if (fd < 0) return -1;
+    int reuse = 1;
+    ::setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+    sockaddr_in address{};
+    address.sin_family = AF_INET;
+    address.sin_port = htons(static_cast<uint16_t>(port));
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    if (::bind(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0 || ::listen(fd, 64) != 0) {
+        ::close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+void print_serve_usage() {
+    std::cerr << "Usage: lumin serve (--socket <path> | --port N) [--workers W] [--hash MB] [--cache N]\n";
+}
+
+} // namespace
+
+//----------------------------------------------------------------------
+// lumin serve
+//----------------------------------------------------------------------
+
+int serve_main(const std::vector<std::string>& args) {
+    std::string socket_path;
+    int port = 0;
+    int workers = std::max(1u, std::thread::hardware_concurrency());
+    int hash_mb = 256;
+    long long cache_entries = 4096;
+
+    for (size_t i = 0; i < args.size(); ++i) {
+        const std::string& arg = args[i];
+        bool has_value = i + 1 < args.size();
+        if      (arg == "--socket" && has_value)  socket_path = args[++i];
+        else if (arg == "--port" && has_value)    port = std::atoi(args[++i].c_str());
+        else if (arg == "--workers" && has_value) workers = std::atoi(args[++i].c_str());
+        else if (arg == "--hash" && has_value)    hash_mb = std::atoi(args[++i].c_str());
+        else if (arg == "--cache" && has_value)   cache_entries = std::atoll(args[++i].c_str());
+        else {
+            print_serve_usage();
+            return 1;
+        }
+    }
+    if (socket_path.empty() == (port <= 0) || port > 65535) {
+        print_serve_usage();
+        return 1;
+    }
+    workers = std::clamp(workers, 1, SearchStats::MAX_THREADS);
+
+    int listener = socket_path.empty() ? listen_tcp(port) : listen_unix(socket_path);
+    if (listener < 0) {
+        std::cerr << "Cannot listen on " << (socket_path.empty() ? "port " + std::to_string(port) : socket_path)
+                  << ": " << std::strerror(errno) << "\n";
+        return 1;
+    }
+
+    // Each worker runs single-threaded searches; MultiPV comes with each request
+    search_threads = 1;
+
+    Server server(static_cast<size_t>(std::max(1, hash_mb)), static_cast<size_t>(std::max(0LL, cache_entries)),
+                  workers);
+    std::vector<std::thread> pool;
+    for (int id = 0; id < workers; ++id) pool.emplace_back(search_worker, std::ref(server), id);
+
+    std::cerr << "Serving on " << (socket_path.empty() ? "127.0.0.1:" + std::to_string(port) : socket_path)
+              << " with " << workers << " worker(s), " << hash_mb << " MB hash\n";
+
+    // Polled so a shutdown request is noticed without a new connection
+    while (!server.shutting_down) {
+        reap_readers(server);
+        pollfd waiting{listener, POLLIN, 0};
+        if (::poll(&waiting, 1, 200) <= 0) continue;
+        int client = ::accept(listener, nullptr, nullptr);
+        if (client < 0) continue;
+
+        auto connection = std::make_shared<Connection>(client);
+        auto done = std::make_shared<std::atomic<bool>>(false);
+        std::thread thread(connection_reader, std::ref(server), connection, done);
+        server.readers.push_back(Server::Reader{std::move(thread), done, connection});
+    }
+
+    ::close(listener);
+    if (!socket_path.empty()) ::unlink(socket_path.c_str());
+
+    // Cut running searches short, drop queued ones, then let the readers
+    // see their sockets close
+    for (TimeManager& timer : server.timers) timer.request_stop();
+    server.queue.close();
+    for (std::thread& worker : pool) worker.join();
+    for (Server::Reader& reader : server.readers)
+        if (auto connection = reader.connection.lock()) ::shutdown(connection->fd, SHUT_RDWR);
+    for (Server::Reader& reader : server.readers) reader.thread.join();
+
+    std::cerr << "Served " << server.requests << " requests: " << server.searches << " searches, "
+              << server.cache_hits << " cache hits, " << server.errors << " errors\n";
+    return 0;
+}
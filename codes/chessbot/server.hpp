@@ -0,0 +1,23 @@
+#ifndef SERVER_HPP
+#define SERVER_HPP
+
+#include <string>
+#include <vector>
+
+// lumin serve (--socket <path> | --port N) [--workers W] [--hash MB] [--cache N]
+//
+// Analysis server for local tools. Clients connect to a Unix domain
+// socket or to a TCP port on 127.0.0.1 and send one JSON object per line:
+//
+//   {"id": 1, "fen": "...", "depth": 12, "nodes": 0, "movetime": 0, "multipv": 1}
+//   {"cmd": "stats"}      counters of the server
+//   {"cmd": "shutdown"}   stops the server once running searches are cut short
+//
+// Each request gets one JSON line back, in completion order, carrying its
+// id. Searches are queued to W workers that all probe and fill one table
+// kept for the life of the server. Answers are cached by position, limits
+// and MultiPV (least recently used out); a repeated request is answered
+// from the cache without a search. Returns the process exit code.
+int serve_main(const std::vector<std::string>& args);
+
+#endif // SERVER_HPP
@@ -0,0 +1,31 @@
+from setuptools import setup
+from pybind11.setup_helpers import Pybind11Extension, build_ext
+
+# Engine sources, as in the Makefile, without the command line entry point
+engine_sources = [
+    "movegen.cpp", "magic.cpp", "nonmagic.cpp", "attacks.cpp", "bitboard.cpp",
+    "position.cpp", "epd.cpp", "movedef.cpp", "perftest.cpp", "uci.cpp", "game.cpp",
+    "search.cpp", "mcts.cpp", "mate.cpp", "timeman.cpp", "tt.cpp", "book.cpp",
+    "bitbase.cpp", "datagen.cpp", "zobrist.cpp", "stats.cpp", "bench.cpp", "analyze.cpp",
+    "match.cpp", "tune.cpp", "server.cpp", "trace.cpp",
+    "Evaluation/basiceval.cpp", "Evaluation/pestoeval.cpp",
+]
+
+ext_modules = [
+    Pybind11Extension(
+        "lumin",  # Python module name
+        engine_sources + ["bindings.cpp"],
+        cxx_std=17,  # C++17 standard
+        extra_compile_args=["-O3"],
+    ),
+]
+
+setup(
+    name="lumin",
+    version="0.1.0",
+    author="You",
+    description="Lumin chess engine with Python bindings via pybind11",
+    ext_modules=ext_modules,
+    cmdclass={"build_ext": build_ext},
+    zip_safe=False,
+)
@@ -0,0 +1,151 @@
+#include "stats.hpp"
+#include <chrono>
+#include <iostream>
+#include <iomanip>
+#include <sstream>
+
+namespace SearchStats {
+    Group global_group;
+    thread_local Group* current_group = &global_group;
+    thread_local ThreadCounters* local_slot = &global_group.slots[0];
+
+    using Clock = std::chrono::steady_clock;
+
+    static uint64_t load(const Counter& counter) {
+        return counter.load(std::memory_order_relaxed);
+    }
+
+    Totals& Totals::operator+=(const Totals& other) {
+        nodes += other.nodes;
+        qnodes += other.qnodes;
+        tt_probes += other.tt_probes;
+        tt_hits += other.tt_hits;
+        beta_cutoffs += other.beta_cutoffs;
+        first_move_cutoffs += other.first_move_cutoffs;
+        null_move_tries += other.null_move_tries;
+        null_move_cutoffs += other.null_move_cutoffs;
+        lmr_reductions += other.lmr_reductions;
+        lmr_researches += other.lmr_researches;
+        time_ms += other.time_ms;
+        return *this;
+    }
+
+    void use_group(Group* group) {
+        current_group = group;
+        local_slot = &group->slots[0];
+    }
+
+    void bind_thread(int id) {
+        local_slot = &current_group->slots[id < MAX_THREADS ? id : MAX_THREADS - 1];
+    }
+
+    void reset_counters() {
+        Group& group = *current_group;
+        for (ThreadCounters& slot : group.slots) {
+            slot.nodes.store(0, std::memory_order_relaxed);
+#ifdef LUMIN_STATS
+            slot.qnodes.store(0, std::memory_order_relaxed);
+            slot.tt_probes.store(0, std::memory_order_relaxed);
+            slot.tt_hits.store(0, std::memory_order_relaxed);
+            slot.beta_cutoffs.store(0, std::memory_order_relaxed);
+            slot.first_move_cutoffs.store(0, std::memory_order_relaxed);
+            slot.null_move_tries.store(0, std::memory_order_relaxed);
+            slot.null_move_cutoffs.store(0, std::memory_order_relaxed);
+            slot.lmr_reductions.store(0, std::memory_order_relaxed);
+            slot.lmr_researches.store(0, std::memory_order_relaxed);
+#endif
+        }
+        group.depths.clear();
+        group.start_time = Clock::now();
+        group.running = true;
+    }
+
+    void finish() {
+        current_group->end_time = Clock::now();
+        current_group->running = false;
+    }
+
+    double get_search_time_ms() {
+        const Group& group = *current_group;
+        Clock::time_point end = group.running ? Clock::now() : group.end_time;
+        return std::chrono::duration<double, std::milli>(end - group.start_time).count();
+    }
+
+    void record_depth(int depth) {
+        current_group->depths.push_back({depth, get_search_time_ms(), get_positions_searched()});
+    }
+
+    uint64_t get_positions_searched() {
+        uint64_t nodes = 0;
+        for (const ThreadCounters& slot : current_group->slots) nodes += load(slot.nodes);
+        return nodes;
+    }
+
+    Totals collect() {
+        Totals totals;
+        for (const ThreadCounters& slot : current_group->slots) {
+            totals.nodes += load(slot.nodes);
+#ifdef LUMIN_STATS
+            totals.qnodes += load(slot.qnodes);
+            totals.tt_probes += load(slot.tt_probes);
+            totals.tt_hits += load(slot.tt_hits);
+            totals.beta_cutoffs += load(slot.beta_cutoffs);
+            totals.first_move_cutoffs += load(slot.first_move_cutoffs);
+            totals.null_move_tries += load(slot.null_move_tries);
+            totals.null_move_cutoffs += load(slot.null_move_cutoffs);
+            totals.lmr_reductions += load(slot.lmr_reductions);
+            totals.lmr_researches += load(slot.lmr_researches);
+#endif
+        }
+        totals.time_ms = get_search_time_ms();
+        totals.depths = current_group->depths;
+        return totals;
+    }
+
+    static double ratio(uint64_t part, uint64_t whole) {
+        return whole ? static_cast<double>(part) / whole : 0.0;
+    }
+
+    std::string to_json(const Totals& t) {
+        std::ostringstream out;
+        out << std::fixed << std::setprecision(3)
+            << "{\"nodes\": " << t.nodes
+            << ", \"qnodes\": " << t.qnodes
+            << ", \"time_ms\": " << t.time_ms
+            << ", \"nps\": " << static_cast<uint64_t>(t.time_ms > 0 ? t.nodes * 1000.0 / t.time_ms : 0)
+            << ", \"tt_probes\": " << t.tt_probes
+            << ", \"tt_hits\": " << t.tt_hits
+            << ", \"tt_hit_rate\": " << ratio(t.tt_hits, t.tt_probes)
+            << ", \"beta_cutoffs\": " << t.beta_cutoffs
+            << ", \"first_move_cutoffs\": " << t.first_move_cutoffs
+            << ", \"first_move_cutoff_rate\": " << ratio(t.first_move_cutoffs, t.beta_cutoffs)
+            << ", \"null_move_tries\": " << t.null_move_tries
+            << ", \"null_move_cutoffs\": " << t.null_move_cutoffs
+            << ", \"lmr_reductions\": " << t.lmr_reductions
+            << ", \"lmr_researches\": " << t.lmr_researches
+            << ", \"depths\": [";
+        for (size_t i = 0; i < t.depths.size(); ++i) {
+            out << (i ? ", " : "") << "{\"depth\": " << t.depths[i].depth
+                << ", \"time_ms\": " << t.depths[i].time_ms
+                << ", \"nodes\": " << t.depths[i].nodes << "}";
+        }
+        out << "]}";
+        return out.str();
+    }
+
+    void print_uci(const Totals& t) {
+        std::ostringstream out;
+        out << std::fixed << std::setprecision(3)
+            << "info string stats nodes " << t.nodes << " qnodes " << t.qnodes
+            << " ttprobes " << t.tt_probes << " tthits " << t.tt_hits
+            << " cutoffs " << t.beta_cutoffs << " firstcutoffs " << t.first_move_cutoffs
+            << " ordering " << ratio(t.first_move_cutoffs, t.beta_cutoffs)
+            << " nulltries " << t.null_move_tries << " nullcutoffs " << t.null_move_cutoffs
+            << " lmr " << t.lmr_reductions << " lmrresearches " << t.lmr_researches << "\n";
+        for (const DepthStat& d : t.depths) {
+            out << "info string stats depth " << d.depth << " time " << d.time_ms
+                << " nodes " << d.nodes << "\n";
+        }
+        std::cout << out.str() << std::flush;
+    }
+}
@@ -0,0 +1,120 @@
+#ifndef STATS_HPP
+#define STATS_HPP
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+//----------------------------------------------------------------------
+// Search statistics
+//
+// Every search thread counts into its own cache-line-aligned slot with a
+// relaxed load + store (single writer), so the hot path never touches a
+// line another thread writes. Totals are summed over the slots on demand.
+//
+// The slots of one search (main thread + Lazy SMP helpers) form a Group.
+// Everything runs against the global group unless a batch tool running
+// several independent searches gives each worker its own (use_group).
+//
+// The node count is always kept: the time manager, nps and bench need it.
+// The detailed counters only exist when built with -DLUMIN_STATS
+// (make STATS=1); otherwise STATS_INC expands to nothing.
+//----------------------------------------------------------------------
+
+#ifdef LUMIN_STATS
+#define STATS_INC(field) SearchStats::bump(SearchStats::local().field)
+#else
+#define STATS_INC(field) ((void)0)
+#endif
+
+namespace SearchStats {
+#ifdef LUMIN_STATS
+    constexpr bool enabled = true;
+#else
+    constexpr bool enabled = false;
+#endif
+
+    // Upper bound on concurrent search threads (UCI option "Threads")
+    constexpr int MAX_THREADS = 64;
+
+    using Counter = std::atomic<uint64_t>;
+
+    struct alignas(64) ThreadCounters {
+        Counter nodes{0};                // negamax + quiescence nodes
+#ifdef LUMIN_STATS
+        Counter qnodes{0};               // quiescence nodes only
+        Counter tt_probes{0};
+        Counter tt_hits{0};
+        Counter beta_cutoffs{0};
+        Counter first_move_cutoffs{0};   // cutoffs on the first move searched
+        Counter null_move_tries{0};      // stay 0 until the search prunes
+        Counter null_move_cutoffs{0};    //   with null moves
+        Counter lmr_reductions{0};       // stay 0 until the search reduces
+        Counter lmr_researches{0};       //   late moves
+#endif
+    };
+
+    // One completed iteration of the main thread
+    struct DepthStat {
+        int depth;
+        double time_ms;      // since the start of the search
+        uint64_t nodes;      // all threads, since the start of the search
+    };
+
+    // Plain snapshot of every slot, summed
+    struct Totals {
+        uint64_t nodes = 0;
+        uint64_t qnodes = 0;
+        uint64_t tt_probes = 0;
+        uint64_t tt_hits = 0;
+        uint64_t beta_cutoffs = 0;
+        uint64_t first_move_cutoffs = 0;
+        uint64_t null_move_tries = 0;
+        uint64_t null_move_cutoffs = 0;
+        uint64_t lmr_reductions = 0;
+        uint64_t lmr_researches = 0;
+        double time_ms = 0.0;
+        std::vector<DepthStat> depths;
+
+        // Sums several searches; per-depth timings are per search and not merged
+        Totals& operator+=(const Totals& other);
+    };
+
+    struct Group {
+        ThreadCounters slots[MAX_THREADS];
+        std::chrono::steady_clock::time_point start_time = std::chrono::steady_clock::now();
+        std::chrono::steady_clock::time_point end_time = start_time;
+        bool running = false;
+        std::vector<DepthStat> depths;
+    };
+
+    extern Group global_group;
+    extern thread_local Group* current_group;
+    extern thread_local ThreadCounters* local_slot;
+
+    inline ThreadCounters& local() { return *local_slot; }
+
+    inline void bump(Counter& counter) {
+        counter.store(counter.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    }
+
+    // Counts one node for the calling thread
+    inline void count_node() { bump(local_slot->nodes); }
+
+    void use_group(Group* group);      // the calling thread's searches count into group
+    void bind_thread(int id);          // the calling thread counts into slot id
+    void reset_counters();             // zero every slot and restart the clock
+    void finish();                     // freeze the clock at the end of a search
+    void record_depth(int depth);      // main thread, after each completed iteration
+
+    Totals collect();
+    uint64_t get_positions_searched(); // nodes of all threads
+    double get_search_time_ms();       // running search, or the last one once finished
+
+    std::string to_json(const Totals& totals);
+    void print_uci(const Totals& totals);   // "info string ..." lines
+}
+
+#endif // STATS_HPP
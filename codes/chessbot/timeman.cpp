@@ -0,0 +1,82 @@
+#include "timeman.hpp"
+#include "stats.hpp"
+#include <algorithm>
+
+// Soft-limit scale indexed by how many iterations in a row returned the
+// same best move: an unstable root gets more time, a settled one less.
+static constexpr double stability_scale[5] = {1.6, 1.2, 1.0, 0.75, 0.5};
+
+void TimeManager::start(const SearchLimits& limits, Color us) {
+    start_ns.store(now_ns(), std::memory_order_relaxed);
+    pondering.store(limits.ponder, std::memory_order_relaxed);
+    stop.store(stop_requested.load(std::memory_order_relaxed), std::memory_order_relaxed);
+    node_limit = limits.nodes;
+    last_best = 0;
+    stability = 0;
+    use_time = false;
+    soft_ms = hard_ms = 0;
+
+    if (limits.infinite) return;
+
+    if (limits.movetime > 0) {
+        // Fixed time per move: spend all of it, never stop early
+        use_time = true;
+        soft_ms = hard_ms = std::max(1, limits.movetime - MOVE_OVERHEAD_MS);
+        return;
+    }
+
+    int remaining = limits.time[us];
+    if (remaining <= 0) return;   // depth / nodes only
+
+    int inc = limits.inc[us];
+    int moves_left = limits.movestogo > 0 ? std::min(limits.movestogo, 40) : 30;
+
+    // Never plan on more than what is on the clock minus the overhead
+    int64_t usable = std::max<int64_t>(1, remaining - MOVE_OVERHEAD_MS);
+    int64_t base = remaining / moves_left + inc * 3 / 4;
+
+    use_time = true;
+    soft_ms = std::max<int64_t>(1, std::min<int64_t>(base, usable / 2));
+    hard_ms = std::max<int64_t>(soft_ms, std::min<int64_t>(base * 4, usable * 2 / 3));
+}
+
+int64_t TimeManager::now_ns() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+int64_t TimeManager::elapsed_ms() const {
+    return (now_ns() - start_ns.load(std::memory_order_relaxed)) / 1000000;
+}
+
+void TimeManager::ponderhit() {
+    start_ns.store(now_ns(), std::memory_order_relaxed);
+    pondering.store(false, std::memory_order_relaxed);
+}
+
+void TimeManager::check_limits() {
+    if (is_pondering()) return;
+    if (node_limit && SearchStats::get_positions_searched() >= node_limit) {
+        stop_now();
+        return;
+    }
+    if (use_time && elapsed_ms() >= hard_ms) {
+        stop_now();
+    }
+}
+
+bool TimeManager::iteration_done(Move best_move) {
+    if (stopped()) return true;
+
+    stability = (best_move == last_best) ? std::min(stability + 1, 4) : 0;
+    last_best = best_move;
+
+    if (!use_time || is_pondering()) return false;
+
+    int64_t elapsed = elapsed_ms();
+    if (soft_ms == hard_ms) return elapsed >= hard_ms;   // movetime
+
+    // The next iteration costs several times the last one, so do not start
+    // it once most of the (stability-scaled) soft budget is gone.
+    return elapsed >= static_cast<int64_t>(soft_ms * stability_scale[stability] * 0.6);
+}
@@ -0,0 +1,93 @@
+#ifndef TIMEMAN_HPP
+#define TIMEMAN_HPP
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include "types.hpp"
+#include "movedef.hpp"
+
+// What the caller allows the search to spend. Zero means "no limit".
+struct SearchLimits {
+    int depth = 0;               // plies
+    uint64_t nodes = 0;          // total nodes
+    int movetime = 0;            // exact time per move (ms)
+    int time[2] = {0, 0};        // remaining clock per colour (ms)
+    int inc[2] = {0, 0};         // increment per colour (ms)
+    int movestogo = 0;           // moves until the next time control
+    bool infinite = false;       // search until stopped from outside
+    bool ponder = false;         // opponent's time: no deadline until ponderhit
+    int mate = 0;                // "go mate N": run the mate solver instead
+};
+
+// Time manager: turns SearchLimits into a soft and a hard deadline and owns
+// the single stop flag every search thread polls.
+//
+//  - hard limit: checked every POLL_INTERVAL nodes, raises the stop flag
+//  - soft limit: checked between iterations, scaled down when the best move
+//    has been stable for several iterations and up when it keeps changing
+//  - pondering: both limits are computed but ignored until ponderhit(),
+//    which restarts the clock so only our own time is charged
+class TimeManager {
+public:
+    static constexpr int POLL_INTERVAL = 1024;     // nodes between clock reads
+    static constexpr int MOVE_OVERHEAD_MS = 30;    // GUI / IO latency reserve
+
+    std::atomic<bool> stop{false};
+
+    void start(const SearchLimits& limits, Color us);
+
+    // Hot path: cheap counter, reads the clock only every POLL_INTERVAL calls
+    inline bool poll() {
+        static thread_local int countdown = POLL_INTERVAL;
+        if (--countdown <= 0) {
+            countdown = POLL_INTERVAL;
+            check_limits();
+        }
+        return stop.load(std::memory_order_relaxed);
+    }
+
+    inline bool stopped() const { return stop.load(std::memory_order_relaxed); }
+    void stop_now() { stop.store(true, std::memory_order_relaxed); }
+
+    // External stop (UCI "stop"). Unlike stop_now() it is sticky: a start()
+    // racing with it still sees it, until clear_stop_request() re-arms us.
+    void request_stop() {
+        stop_requested.store(true, std::memory_order_relaxed);
+        stop.store(true, std::memory_order_relaxed);
+    }
+    void clear_stop_request() { stop_requested.store(false, std::memory_order_relaxed); }
+    bool is_stop_requested() const { return stop_requested.load(std::memory_order_relaxed); }
+
+    // The predicted move was played: the ponder search becomes the real one.
+    // Safe to call from another thread while the search runs.
+    void ponderhit();
+    bool is_pondering() const { return pondering.load(std::memory_order_relaxed); }
+
+    // Called after every completed iteration. Returns true when starting
+    // another iteration is not worth it.
+    bool iteration_done(Move best_move);
+
+    int64_t elapsed_ms() const;
+    int64_t soft_limit_ms() const { return soft_ms; }
+    int64_t hard_limit_ms() const { return hard_ms; }
+    bool is_time_managed() const { return use_time; }
+
+private:
+    void check_limits();
+
+    static int64_t now_ns();
+
+    std::atomic<int64_t> start_ns{0};   // steady clock, rewritten by ponderhit()
+    std::atomic<bool> pondering{false};
+    int64_t soft_ms = 0;
+    int64_t hard_ms = 0;
+    uint64_t node_limit = 0;
+    bool use_time = false;
+    std::atomic<bool> stop_requested{false};
+
+    Move last_best = 0;
+    int stability = 0;
+};
+
+#endif // TIMEMAN_HPP
@@ -0,0 +1,269 @@
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <mutex>
+
+#include "trace.hpp"
+
+namespace Trace {
+
+namespace {
+
+constexpr char MAGIC[8] = {'L', 'U', 'M', 'I', 'N', 'T', 'R', 'C'};
+constexpr size_t HEADER_BYTES = 32;
+
+struct FileHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t event_bytes;
+};
+static_assert(sizeof(FileHeader) <= HEADER_BYTES, "trace header overflows its slot");
+
+} // namespace
+
+//----------------------------------------------------------------------
+// Recording
+//----------------------------------------------------------------------
+
+#ifdef LUMIN_TRACE
+
+thread_local int current_ply = 0;
+
+namespace {
+
+std::mutex file_lock;
+std::FILE* file = nullptr;
+std::atomic<bool> active{false};
+std::atomic<uint32_t> next_thread{0};
+
+struct Ring {
+    uint32_t thread = next_thread++;
+    std::vector<Event> events;
+
+    Ring() { events.reserve(RING_EVENTS); }
+    ~Ring() { write(); }     // the thread ends: what it still holds goes out
+
+    void write() {
+        if (events.empty()) return;
+        std::lock_guard<std::mutex> lk(file_lock);
+        if (file) {
+            uint32_t block[2] = {thread, static_cast<uint32_t>(events.size())};
+            std::fwrite(block, sizeof(block), 1, file);
+            std::fwrite(events.data(), sizeof(Event), events.size(), file);
+        }
+        events.clear();
+    }
+};
+
+thread_local Ring ring;
+
+} // namespace
+
+bool open(const std::string& path) {
+    std::lock_guard<std::mutex> lk(file_lock);
+    if (file) std::fclose(file);
+    file = std::fopen(path.c_str(), "wb");
+    if (!file) return false;
+
+    char header[HEADER_BYTES] = {};
+    FileHeader info{};
+    std::memcpy(info.magic, MAGIC, sizeof(MAGIC));
+    info.version = FILE_VERSION;
+    info.event_bytes = sizeof(Event);
+    std::memcpy(header, &info, sizeof(info));
+    std::fwrite(header, HEADER_BYTES, 1, file);
+    active = true;
+    return true;
+}
+
+void close() {
+    ring.write();
+    std::lock_guard<std::mutex> lk(file_lock);
+    active = false;
+    if (file) std::fclose(file);
+    file = nullptr;
+}
+
+bool recording() {
+    return active.load(std::memory_order_relaxed);
+}
+
+void record(const Event& event) {
+    ring.events.push_back(event);
+    if (ring.events.size() >= RING_EVENTS) ring.write();
+}
+
+void flush() {
+    ring.write();
+    std::lock_guard<std::mutex> lk(file_lock);
+    if (file) std::fflush(file);
+}
+
+void iteration(int depth) {
+    if (!recording()) return;
+    Event event{};
+    event.kind = Iteration;
+    event.depth = static_cast<uint8_t>(depth);
+    event.cutoff_index = NO_CUTOFF;
+    record(event);
+}
+
+#endif // LUMIN_TRACE
+
+//----------------------------------------------------------------------
+// Reading
+//----------------------------------------------------------------------
+
+bool read_file(const std::string& path, std::vector<ThreadTrace>& threads) {
+    std::ifstream in(path, std::ios::binary);
+    char header[HEADER_BYTES];
+    if (!in.read(header, HEADER_BYTES)) return false;
+    FileHeader info;
+    std::memcpy(&info, header, sizeof(info));
+    if (std::memcmp(info.magic, MAGIC, sizeof(MAGIC)) != 0 || info.version != FILE_VERSION
+        || info.event_bytes != sizeof(Event)) return false;
+
+    std::map<uint32_t, size_t> slot;     // thread -> index in `threads`
+    threads.clear();
+    uint32_t block[2];
+    while (in.read(reinterpret_cast<char*>(block), sizeof(block))) {
+        auto it = slot.find(block[0]);
+        if (it == slot.end()) {
+            it = slot.emplace(block[0], threads.size()).first;
+            threads.push_back(ThreadTrace{block[0], {}});
+        }
+        std::vector<Event>& events = threads[it->second].events;
+        size_t first = events.size();
+        events.resize(first + block[1]);
+        if (!in.read(reinterpret_cast<char*>(events.data() + first), static_cast<std::streamsize>(block[1] * sizeof(Event))))
+            return false;   // truncated block
+    }
+    return in.eof();
+}
+
+} // namespace Trace
+
+//----------------------------------------------------------------------
+// lumin trace
+//----------------------------------------------------------------------
+
+namespace {
+
+const char* outcome_name(int outcome) {
+    static const char* names[] = {"all moves", "beta cutoff", "tt cutoff", "mate/stalemate",
+                                  "bitbase", "stand pat", "depth limit", "aborted"};
+    return outcome >= 0 && outcome <= Trace::Aborted ? names[outcome] : "?";
+}
+
+double percent(uint64_t part, uint64_t whole) {
+    return whole ? 100.0 * part / whole : 0.0;
+}
+
+void print_cutoff_histogram(const char* title, const uint64_t (&by_index)[11], uint64_t nodes) {
+    uint64_t cutoffs = 0;
+    for (uint64_t count : by_index) cutoffs += count;
+    std::cout << title << ": " << cutoffs << " (" << std::setprecision(1) << percent(cutoffs, nodes)
+              << "% of nodes)\n";
+    for (int i = 0; i < 11; ++i) {
+        if (!by_index[i]) continue;
+        std::cout << "  move " << std::setw(3) << (i < 10 ? std::to_string(i + 1) : ">10") << ": "
+                  << std::setw(10) << by_index[i] << "  " << std::setw(5) << percent(by_index[i], cutoffs) << "%\n";
+    }
+}
+
+} // namespace
+
+int trace_main(const std::vector<std::string>& args) {
+    if (args.size() != 1) {
+        std::cerr << "Usage: lumin trace <file>\n";
+        return 1;
+    }
+    std::vector<Trace::ThreadTrace> threads;
+    if (!Trace::read_file(args[0], threads)) {
+        std::cerr << "Cannot read " << args[0] << " as a search trace\n";
+        return 1;
+    }
+
+    uint64_t kinds[2] = {0, 0};
+    uint64_t outcomes[2][Trace::Aborted + 1] = {};
+    uint64_t cutoffs[2][11] = {};
+    uint64_t tt_hits = 0, qdepth[256] = {};
+    uint64_t ply_sum = 0;
+    int max_ply = 0, max_qdepth = 0;
+
+    std::cout << std::fixed;
+    for (const Trace::ThreadTrace& thread : threads) {
+        for (const Trace::Event& event : thread.events) {
+            if (event.kind > Trace::Qsearch) continue;
+            kinds[event.kind] += 1;
+            outcomes[event.kind][std::min<int>(event.outcome, Trace::Aborted)] += 1;
+            if (event.outcome == Trace::BetaCutoff && event.cutoff_index != Trace::NO_CUTOFF)
+                cutoffs[event.kind][std::min<int>(event.cutoff_index, 10)] += 1;
+            if (event.kind == Trace::Search) {
+                tt_hits += event.tt_hit;
+                ply_sum += event.ply;
+                max_ply = std::max<int>(max_ply, event.ply);
+            } else {
+                qdepth[event.depth] += 1;
+                max_qdepth = std::max<int>(max_qdepth, event.depth);
+            }
+        }
+    }
+
+    uint64_t total = kinds[0] + kinds[1];
+    std::cout << "Nodes: " << total << " from " << threads.size() << " thread(s), "
+              << kinds[0] << " search + " << kinds[1] << " quiescence (" << std::setprecision(1)
+              << percent(kinds[1], total) << "%)\n";
+    std::cout << "Search plies: mean " << std::setprecision(2) << (kinds[0] ? double(ply_sum) / kinds[0] : 0.0)
+              << ", max " << max_ply << "; TT hits " << std::setprecision(1) << percent(tt_hits, kinds[0]) << "%\n";
+
+    for (int kind = 0; kind < 2; ++kind) {
+        std::cout << (kind == 0 ? "Search" : "Quiescence") << " outcomes:\n";
+        for (int outcome = 0; outcome <= Trace::Aborted; ++outcome) {
+            if (!outcomes[kind][outcome]) continue;
+            std::cout << "  " << std::left << std::setw(15) << outcome_name(outcome) << std::right
+                      << std::setw(12) << outcomes[kind][outcome] << "  " << std::setw(5)
+                      << percent(outcomes[kind][outcome], kinds[kind]) << "%\n";
+        }
+    }
+
+    // Effective branching factor: nodes of iteration d over nodes of
+    // iteration d - 1, summed over every search in the file. Only threads
+    // that write iteration markers (the main search thread) count.
+    std::map<int, std::pair<uint64_t, uint64_t>> by_depth;     // depth -> (iterations, nodes)
+    for (const Trace::ThreadTrace& thread : threads) {
+        std::pair<uint64_t, uint64_t>* current = nullptr;
+        for (const Trace::Event& event : thread.events) {
+            if (event.kind == Trace::Iteration) {
+                current = &by_depth[event.depth];
+                current->first += 1;
+            } else if (current) {
+                current->second += 1;
+            }
+        }
+    }
+    if (!by_depth.empty()) std::cout << "Iterations:\n";
+    uint64_t previous = 0;
+    for (const auto& [depth, totals] : by_depth) {
+        std::cout << "  depth " << std::setw(2) << depth << ": " << std::setw(6) << totals.first << " searches "
+                  << std::setw(12) << totals.second << " nodes";
+        if (previous) std::cout << "  EBF " << std::setprecision(2) << double(totals.second) / previous;
+        std::cout << "\n";
+        previous = totals.second;
+    }
+
+    print_cutoff_histogram("Search beta cutoffs by move index", cutoffs[0], kinds[0]);
+    print_cutoff_histogram("Quiescence beta cutoffs by capture index", cutoffs[1], kinds[1]);
+
+    std::cout << "Quiescence depth:\n";
+    for (int depth = 1; depth <= max_qdepth; ++depth) {
+        std::cout << "  " << std::setw(2) << depth << ": " << std::setw(12) << qdepth[depth] << "  "
+                  << std::setprecision(1) << std::setw(5) << percent(qdepth[depth], kinds[1]) << "%\n";
+    }
+    return 0;
+}
@@ -0,0 +1,140 @@
+#ifndef TRACE_HPP
+#define TRACE_HPP
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+//----------------------------------------------------------------------
+// Search tracer
+//
+// Built with -DLUMIN_TRACE (make TRACE=1), negamax and Quiescence record
+// one event per node when it returns: ply, remaining (or quiescence)
+// depth, the alpha/beta window it was called with, its result, how it
+// ended, the index of the move that cut off and whether the TT had the
+// position. Events go into a ring buffer owned by the thread; a full
+// buffer is appended to the trace file as one block, so the search only
+// takes a lock once per RING_EVENTS nodes. Recording starts when a file is
+// opened (lumin --trace <file>) and the summary tool reads it back
+// (lumin trace <file>).
+//
+// Without LUMIN_TRACE the TRACE_* macros expand to plain code (a return,
+// or nothing), so the release search is unchanged.
+//----------------------------------------------------------------------
+
+namespace Trace {
+
+enum Kind : uint8_t {
+    Search,         // negamax node
+    Qsearch,        // quiescence node
+    Iteration       // marker: the main thread starts iteration `depth`
+};
+
+// How a node ended
+enum Outcome : uint8_t {
+    AllMoves,       // every move searched: exact score or fail low
+    BetaCutoff,
+    TTCutoff,
+    Terminal,       // mate or stalemate
+    BitbaseHit,
+    StandPat,       // quiescence: static evaluation >= beta
+    DepthLimit,     // quiescence: maximum depth reached
+    Aborted         // the search was stopped
+};
+
+constexpr uint8_t NO_CUTOFF = 255;
+
+struct Event {
+    int32_t alpha;
+    int32_t beta;
+    int32_t score;
+    uint32_t move;          // best or cutoff move, 0 when none
+    uint16_t moves;         // moves generated at the node
+    uint8_t ply;            // distance from the root (iteration markers: 0)
+    uint8_t depth;          // remaining depth; quiescence depth; iteration depth
+    uint8_t kind;
+    uint8_t outcome;
+    uint8_t cutoff_index;   // 0-based position of the cutoff move, NO_CUTOFF when none
+    uint8_t tt_hit;
+};
+static_assert(sizeof(Event) == 24, "trace events are 24 bytes on disk");
+
+// File: 32-byte header ("LUMINTRC", version, event size), then blocks of
+// { uint32 thread, uint32 count, count events }
+constexpr uint32_t FILE_VERSION = 1;
+constexpr size_t RING_EVENTS = 1 << 16;
+
+// Events of one file, grouped by recording thread
+struct ThreadTrace {
+    uint32_t thread;
+    std::vector<Event> events;
+};
+bool read_file(const std::string& path, std::vector<ThreadTrace>& threads);
+
+#ifdef LUMIN_TRACE
+constexpr bool enabled = true;
+
+bool open(const std::string& path);     // starts recording, truncates the file
+void close();                           // flushes the calling thread, stops recording
+bool recording();
+void record(const Event& event);        // into the calling thread's ring
+void flush();                           // the calling thread's ring to the file
+void iteration(int depth);
+
+// Ply of the calling thread's current node
+extern thread_local int current_ply;
+
+// Records the node's event when it goes out of scope, so every return
+// path is covered; TRACE_RETURN fills in the result on the way out
+struct NodeScope {
+    Event event{};
+
+    NodeScope(Kind kind, int depth, int alpha, int beta) {
+        event.kind = kind;
+        event.depth = static_cast<uint8_t>(depth < 255 ? depth : 255);
+        event.alpha = alpha;
+        event.beta = beta;
+        event.cutoff_index = NO_CUTOFF;
+        event.outcome = AllMoves;
+        event.ply = static_cast<uint8_t>(++current_ply < 255 ? current_ply : 255);
+    }
+    ~NodeScope() {
+        --current_ply;
+        if (recording()) record(event);
+    }
+
+    int finish(Outcome outcome, int score) {
+        event.outcome = outcome;
+        event.score = score;
+        return score;
+    }
+};
+#else
+constexpr bool enabled = false;
+#endif
+
+}
+
+#ifdef LUMIN_TRACE
+#define TRACE_NODE(kind, depth, alpha, beta) Trace::NodeScope trace_node(Trace::kind, depth, alpha, beta)
+#define TRACE_SET(field, value) (trace_node.event.field = (value))
+#define TRACE_RETURN(outcome, score) return trace_node.finish(Trace::outcome, score)
+#define TRACE_ITERATION(depth) Trace::iteration(depth)
+#define TRACE_FLUSH() Trace::flush()
+#else
+#define TRACE_NODE(kind, depth, alpha, beta) ((void)0)
+#define TRACE_SET(field, value) ((void)0)
+#define TRACE_RETURN(outcome, score) return (score)
+#define TRACE_ITERATION(depth) ((void)0)
+#define TRACE_FLUSH() ((void)0)
+#endif
+
+// lumin trace <file>
+//
+// Summarizes a trace: nodes per kind and outcome, effective branching
+// factor per iteration of the main thread, where in the move list beta
+// cutoffs happen, TT hit rates and the quiescence depth distribution.
+// Returns the process exit code.
+int trace_main(const std::vector<std::string>& args);
+
+#endif // TRACE_HPP
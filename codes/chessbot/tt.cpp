@@ -0,0 +1,202 @@
+#include "tt.hpp"
+#include "zobrist.hpp"
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+TranspositionTable tt;
+
+//----------------------------------------------------------------------
+// data layout: move (28 bits) | depth (8 bits) | flag (2 bits) | score (26 bits, signed)
+//----------------------------------------------------------------------
+
+U64 TranspositionTable::pack(Move move, int depth, int score, int flag) {
+    return  (static_cast<U64>(move) & 0xFFFFFFFULL)
+          | (static_cast<U64>(depth & 0xFF) << 28)
+          | (static_cast<U64>(flag & 0x3) << 36)
+          | (static_cast<U64>(static_cast<uint32_t>(score) & 0x3FFFFFFULL) << 38);
+}
+
+// Largest power of two <= n, so the index is a mask
+static size_t floor_pow2(size_t n) {
+    size_t pow2 = 1;
+    while (pow2 * 2 <= n) pow2 *= 2;
+    return pow2;
+}
+
+TranspositionTable::TranspositionTable(TranspositionTable& parent, size_t index, size_t parts) {
+    size_t slice = floor_pow2(std::max<size_t>(1, parent.entries / std::max<size_t>(1, parts)));
+    table = parent.table + (index % std::max<size_t>(1, parent.entries / slice)) * slice;
+    entries = slice;
+    mask = slice - 1;
+}
+
+void TranspositionTable::resize(size_t mb) {
+    size_t count = floor_pow2(std::max<size_t>(1, mb) * 1024 * 1024 / sizeof(TTEntry));
+
+    release_mapping();
+    storage.assign(count, TTEntry{0ULL, 0ULL});
+    table = storage.data();
+    entries = count;
+    mask = count - 1;
+}
+
+void TranspositionTable::clear() {
+    std::fill(table, table + entries, TTEntry{0ULL, 0ULL});
+}
+
+bool TranspositionTable::probe(U64 key, TTHit& hit) const {
+    const TTEntry& entry = table[key & mask];
+    U64 data = entry.data;
+    if ((entry.key ^ data) != key || data == 0) return false;
+
+    hit.move  = static_cast<Move>(data & 0xFFFFFFFULL);
+    hit.depth = static_cast<int>((data >> 28) & 0xFF);
+    hit.flag  = static_cast<int>((data >> 36) & 0x3);
+    // sign-extend the 26-bit score
+    hit.score = static_cast<int>(static_cast<int64_t>(data) >> 38);
+    return true;
+}
+
+void TranspositionTable::store(U64 key, int depth, int score, int flag, Move move) {
+    TTEntry& entry = table[key & mask];
+    U64 old_data = entry.data;
+    bool same = (entry.key ^ old_data) == key;
+
+    // Depth-preferred for the same position, always replace a different one
+    if (same && static_cast<int>((old_data >> 28) & 0xFF) > depth) return;
+    // Keep the old best move if this search did not produce one
+    if (same && move == 0) move = static_cast<Move>(old_data & 0xFFFFFFFULL);
+
+    U64 data = pack(move, depth, score, flag);
+    entry.data = data;
+    entry.key = key ^ data;
+}
+
+int TranspositionTable::hashfull() const {
+    size_t sample = std::min<size_t>(1000, entries);
+    int used = 0;
+    for (size_t i = 0; i < sample; ++i)
+        if (table[i].data) ++used;
+    return static_cast<int>(used * 1000 / sample);
+}
+
+//----------------------------------------------------------------------
+// Files: 64-byte header, then the slots as they are in memory
+//----------------------------------------------------------------------
+
+static constexpr char TT_MAGIC[8] = {'L', 'U', 'M', 'I', 'N', 'T', 'T', '\0'};
+static constexpr uint32_t TT_VERSION = 1;
+static constexpr size_t TT_HEADER_BYTES = 64;
+// Field widths of the data word (move, depth, flag, score), see pack()
+static constexpr uint64_t TT_LAYOUT = 28 | (8 << 8) | (2 << 16) | (26 << 24);
+// Written natively: a file from a host of the other byte order reads it swapped
+static constexpr uint32_t TT_BYTE_ORDER = 0x01020304;
+
+struct TTFileHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t entry_bytes;
+    uint64_t entries;
+    uint64_t zobrist;       // fingerprint of the key scheme the slots were hashed with
+    uint64_t layout;
+    uint32_t byte_order;
+};
+static_assert(sizeof(TTFileHeader) <= TT_HEADER_BYTES, "TT header overflows its slot");
+
+// Order-sensitive fold of every Zobrist key: changing the seed, the
+// generator or the key order changes it
+static U64 zobrist_fingerprint() {
+    const U64* keys = &Zobrist::keys.pieces[0][0];
+    const size_t count = sizeof(Zobrist::Keys) / sizeof(U64);
+    U64 hash = 0xCBF29CE484222325ULL;
+    for (size_t i = 0; i < count; ++i) hash = (hash ^ keys[i]) * 0x100000001B3ULL;
+    return hash;
+}
+
+void TranspositionTable::release_mapping() {
+    if (!mapping) return;
+    munmap(mapping, mapped_bytes);
+    mapping = nullptr;
+    mapped_bytes = 0;
+    table = nullptr;
+    entries = 0;
+    mask = 0;
+}
+
+bool TranspositionTable::save(const std::string& path) const {
+    char header[TT_HEADER_BYTES] = {};
+    TTFileHeader info{};
+    std::memcpy(info.magic, TT_MAGIC, sizeof(TT_MAGIC));
+    info.version = TT_VERSION;
+    info.entry_bytes = sizeof(TTEntry);
+    info.entries = entries;
+    info.zobrist = zobrist_fingerprint();
+    info.layout = TT_LAYOUT;
+    info.byte_order = TT_BYTE_ORDER;
+    std::memcpy(header, &info, sizeof(info));
+
+    // Written aside and renamed over the target: a table loaded from that
+    // very file keeps its mapping of the old one
+    std::string temporary = path + ".tmp";
+    {
+        std::ofstream out(temporary, std::ios::binary | std::ios::trunc);
+        if (!out) return false;
+        out.write(header, TT_HEADER_BYTES);
+        out.write(reinterpret_cast<const char*>(table), static_cast<std::streamsize>(entries * sizeof(TTEntry)));
+        if (!out.flush()) {
+            std::remove(temporary.c_str());
+            return false;
+        }
+    }
+    if (std::rename(temporary.c_str(), path.c_str()) != 0) {
+        std::remove(temporary.c_str());
+        return false;
+    }
+    return true;
+}
+
+bool TranspositionTable::load(const std::string& path) {
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) return false;
+    struct stat info;
+    size_t bytes = (fstat(fd, &info) == 0) ? static_cast<size_t>(info.st_size) : 0;
+    // Private and writable: the search stores into its own copies of the pages
+    void* file = bytes > TT_HEADER_BYTES
+        ? mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0) : MAP_FAILED;
+    ::close(fd);
+    if (file == MAP_FAILED) return false;
+
+    TTFileHeader header;
+    std::memcpy(&header, file, sizeof(header));
+    uint64_t count = header.entries;
+    bool valid = std::memcmp(header.magic, TT_MAGIC, sizeof(TT_MAGIC)) == 0
+              && header.version == TT_VERSION
+              && header.byte_order == TT_BYTE_ORDER
+              && header.entry_bytes == sizeof(TTEntry)
+              && header.layout == TT_LAYOUT
+              && header.zobrist == zobrist_fingerprint()
+              && count > 0 && (count & (count - 1)) == 0
+              && bytes >= TT_HEADER_BYTES + count * sizeof(TTEntry);
+    if (!valid) {
+        munmap(file, bytes);
+        return false;
+    }
+
+    // Probes land anywhere in the table
+    madvise(file, bytes, MADV_RANDOM);
+    release_mapping();
+    std::vector<TTEntry>().swap(storage);
+    mapping = file;
+    mapped_bytes = bytes;
+    table = reinterpret_cast<TTEntry*>(static_cast<char*>(file) + TT_HEADER_BYTES);
+    entries = static_cast<size_t>(count);
+    mask = entries - 1;
+    return true;
+}
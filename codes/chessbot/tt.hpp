@@ -0,0 +1,83 @@
+#ifndef TT_HPP
+#define TT_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "types.hpp"
+#include "movedef.hpp"
+
+// Bound stored with a score
+enum TTFlag : uint8_t {
+    TT_NONE  = 0,
+    TT_EXACT = 1,
+    TT_LOWER = 2,   // fail high: score >= stored value
+    TT_UPPER = 3    // fail low:  score <= stored value
+};
+
+struct TTHit {
+    Move move;
+    int  score;
+    int  depth;
+    int  flag;
+};
+
+// One slot: the payload is packed into a single word and the key is stored
+// XOR-ed with it, so a torn write from another thread reads as a miss
+// instead of a wrong hit (lockless hashing, no mutex in the search).
+struct TTEntry {
+    U64 key;
+    U64 data;
+};
+
+class TranspositionTable {
+public:
+    static constexpr size_t DEFAULT_MB = 16;
+
+    explicit TranspositionTable(size_t mb = DEFAULT_MB) { resize(mb); }
+
+    // Slice `index` of `parts` equal slices of `parent`'s memory: independent
+    // searches running side by side each get their own part of one
+    // allocation. The parent must outlive the slice and not be resized.
+    TranspositionTable(TranspositionTable& parent, size_t index, size_t parts);
+
+    ~TranspositionTable() { release_mapping(); }
+
+    TranspositionTable(const TranspositionTable&) = delete;
+    TranspositionTable& operator=(const TranspositionTable&) = delete;
+
+    void resize(size_t mb);
+    void clear();
+
+    // Persistence. save writes a versioned header (layout of the entries,
+    // fingerprint of the Zobrist keys) followed by the raw slots. load maps
+    // such a file copy-on-write and searches straight from the mapping, so
+    // pages are read in as probes touch them and the file is never written;
+    // the table takes the file's size. A file from another build (other
+    // keys or packing) is refused and leaves the table as it was.
+    bool save(const std::string& path) const;
+    bool load(const std::string& path);
+
+    bool probe(U64 key, TTHit& hit) const;
+    void store(U64 key, int depth, int score, int flag, Move move);
+
+    size_t size_mb() const { return entries * sizeof(TTEntry) / (1024 * 1024); }
+    int hashfull() const;   // permille of the first 1000 slots in use
+
+private:
+    static U64 pack(Move move, int depth, int score, int flag);
+    void release_mapping();
+
+    std::vector<TTEntry> storage;   // empty for a slice or a loaded file
+    void* mapping = nullptr;        // loaded file, entries after its header
+    size_t mapped_bytes = 0;
+    TTEntry* table = nullptr;
+    size_t entries = 0;
+    U64 mask = 0;
+};
+
+// Shared by every search thread
+extern TranspositionTable tt;
+
+#endif // TT_HPP
@@ -0,0 +1,332 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <thread>
+
+#include "tune.hpp"
+#include "datagen.hpp"
+#include "bitboard.hpp"
+#include "stats.hpp"
+#include "Evaluation/pestoeval.hpp"
+
+namespace {
+
+// One value per (piece type, square), material included; squares are
+// White's view (a8 = 0), Black pieces read the mirrored square
+constexpr int TABLE_SIZE = 6 * 64;
+constexpr int PARAMS = 2 * TABLE_SIZE;     // midgame tables, then endgame tables
+constexpr int MAX_PHASE = 24;
+
+struct Coefficient {
+    uint16_t index;     // type * 64 + square
+    int16_t sign;       // +1 White piece, -1 Black piece
+};
+
+// The loaded set: the coefficients of position i are
+// coefficients[offsets[i] .. offsets[i + 1])
+struct TuneSet {
+    std::vector<uint32_t> offsets;
+    std::vector<Coefficient> coefficients;
+    std::vector<uint8_t> phases;
+    std::vector<float> results;     // 0, 0.5, 1 for White
+    std::vector<float> scores;      // search score for White, centipawns
+
+    size_t size() const { return phases.size(); }
+};
+
+// Runs body(first, last, worker) over `threads` contiguous chunks of [0, count)
+template<typename Body>
+void parallel_chunks(size_t count, int threads, Body body) {
+    std::vector<std::thread> pool;
+    size_t chunk = (count + threads - 1) / threads;
+    for (int t = 0; t < threads; ++t) {
+        size_t first = std::min(count, t * chunk), last = std::min(count, first + chunk);
+        pool.emplace_back(body, first, last, t);
+    }
+    for (std::thread& thread : pool) thread.join();
+}
+
+TuneSet load_set(const Datagen::DataFile& file, size_t limit, int threads) {
+    const size_t count = std::min(file.size(), limit);
+    TuneSet set;
+    set.offsets.resize(count + 1);
+    set.phases.resize(count);
+    set.results.resize(count);
+    set.scores.resize(count);
+
+    // One coefficient per piece, kings included (their tables are tuned too)
+    set.offsets[0] = 0;
+    for (size_t i = 0; i < count; ++i)
+        set.offsets[i + 1] = set.offsets[i] + count_bits(file[i].occupancy);
+    set.coefficients.resize(set.offsets[count]);
+
+    static const int phase_inc[6] = {0, 1, 1, 2, 4, 0};
+    parallel_chunks(count, threads, [&](size_t first, size_t last, int) {
+        for (size_t i = first; i < last; ++i) {
+            const Datagen::PackedPosition& record = file[i];
+            Coefficient* out = &set.coefficients[set.offsets[i]];
+            int phase = 0, index = 0;
+            for (U64 occupied = record.occupancy; occupied; occupied &= occupied - 1, ++index) {
+                int sq = get_ls1b_index(occupied);
+                int piece = (record.pieces[index / 2] >> (4 * (index & 1))) & 0xF;
+                if (piece >= Em) {
+                    *out++ = Coefficient{0, 0};     // corrupt record: the slot counts for nothing
+                    continue;
+                }
+                bool white = piece < 6;
+                int type = white ? piece : piece - 6;
+                *out++ = Coefficient{static_cast<uint16_t>(type * 64 + (white ? sq : FLIP(sq))),
+                                     static_cast<int16_t>(white ? 1 : -1)};
+                phase += phase_inc[type];
+            }
+            set.phases[i] = static_cast<uint8_t>(std::min(phase, MAX_PHASE));
+            set.results[i] = (record.result + 1) * 0.5f;
+            set.scores[i] = record.score;
+        }
+    });
+    return set;
+}
+
+inline double evaluate(const TuneSet& set, size_t i, const double* params) {
+    double mg = 0.0, eg = 0.0;
+    for (uint32_t c = set.offsets[i]; c < set.offsets[i + 1]; ++c) {
+        const Coefficient& coefficient = set.coefficients[c];
+        mg += coefficient.sign * params[coefficient.index];
+        eg += coefficient.sign * params[TABLE_SIZE + coefficient.index];
+    }
+    double phase = set.phases[i];
+    return (mg * phase + eg * (MAX_PHASE - phase)) / MAX_PHASE;
+}
+
+inline double sigmoid(double k, double eval) {
+    return 1.0 / (1.0 + std::exp(-k * eval / 400.0));
+}
+
+inline double target(const TuneSet& set, size_t i, double k, double lambda) {
+    return lambda * set.results[i] + (1.0 - lambda) * sigmoid(k, set.scores[i]);
+}
+
+// Mean squared error over the set
+double loss(const TuneSet& set, const std::vector<double>& params, double k, double lambda, int threads) {
+    std::vector<double> partial(threads, 0.0);
+    parallel_chunks(set.size(), threads, [&](size_t first, size_t last, int t) {
+        double sum = 0.0;
+        for (size_t i = first; i < last; ++i) {
+            double error = target(set, i, k, lambda) - sigmoid(k, evaluate(set, i, params.data()));
+            sum += error * error;
+        }
+        partial[t] = sum;
+    });
+    double total = 0.0;
+    for (double sum : partial) total += sum;
+    return total / std::max<size_t>(1, set.size());
+}
+
+// Gradient of the loss; each thread sums into its own vector
+double gradient(const TuneSet& set, const std::vector<double>& params, double k, double lambda, int threads,
+                std::vector<double>& grad) {
+    std::vector<std::vector<double>> partial(threads, std::vector<double>(PARAMS, 0.0));
+    std::vector<double> losses(threads, 0.0);
+    parallel_chunks(set.size(), threads, [&](size_t first, size_t last, int t) {
+        double* g = partial[t].data();
+        double sum = 0.0;
+        for (size_t i = first; i < last; ++i) {
+            double s = sigmoid(k, evaluate(set, i, params.data()));
+            double error = target(set, i, k, lambda) - s;
+            sum += error * error;
+
+            // d/d(eval) of error^2, split over the midgame and endgame halves
+            double d = -2.0 * error * s * (1.0 - s) * k / 400.0;
+            double phase = set.phases[i];
+            double d_mg = d * phase / MAX_PHASE, d_eg = d * (MAX_PHASE - phase) / MAX_PHASE;
+            for (uint32_t c = set.offsets[i]; c < set.offsets[i + 1]; ++c) {
+                const Coefficient& coefficient = set.coefficients[c];
+                g[coefficient.index] += coefficient.sign * d_mg;
+                g[TABLE_SIZE + coefficient.index] += coefficient.sign * d_eg;
+            }
+        }
+        losses[t] = sum;
+    });
+
+    const double n = static_cast<double>(std::max<size_t>(1, set.size()));
+    std::fill(grad.begin(), grad.end(), 0.0);
+    double total = 0.0;
+    for (int t = 0; t < threads; ++t) {
+        for (int p = 0; p < PARAMS; ++p) grad[p] += partial[t][p] / n;
+        total += losses[t];
+    }
+    return total / n;
+}
+
+// Golden-section search for the K that best fits the starting tables
+double fit_k(const TuneSet& set, const std::vector<double>& params, double lambda, int threads) {
+    const double ratio = (std::sqrt(5.0) - 1.0) / 2.0;
+    double lo = 0.1, hi = 5.0;
+    double a = hi - ratio * (hi - lo), b = lo + ratio * (hi - lo);
+    double la = loss(set, params, a, lambda, threads), lb = loss(set, params, b, lambda, threads);
+    for (int i = 0; i < 30; ++i) {
+        if (la < lb) {
+            hi = b; b = a; lb = la;
+            a = hi - ratio * (hi - lo);
+            la = loss(set, params, a, lambda, threads);
+        } else {
+            lo = a; a = b; la = lb;
+            b = lo + ratio * (hi - lo);
+            lb = loss(set, params, b, lambda, threads);
+        }
+    }
+    return (lo + hi) / 2.0;
+}
+
+std::vector<double> initial_params() {
+    std::vector<double> params(PARAMS);
+    for (int type = 0; type < 6; ++type) {
+        for (int sq = 0; sq < 64; ++sq) {
+            params[type * 64 + sq] = mg_value[type] + mg_pesto_table[type][sq];
+            params[TABLE_SIZE + type * 64 + sq] = eg_value[type] + eg_pesto_table[type][sq];
+        }
+    }
+    return params;
+}
+
+// Splits the tuned values back into material plus tables: the material
+// is the mean over the squares a piece can stand on, the king keeps 0
+void write_tables(std::ostream& out, const char* prefix, const double* values) {
+    static const char* names[6] = {"pawn", "knight", "bishop", "rook", "queen", "king"};
+    int material[6];
+    for (int type = 0; type < 6; ++type) {
+        double sum = 0.0;
+        int squares = 0;
+        for (int sq = 0; sq < 64; ++sq) {
+            if (type == 0 && (sq < 8 || sq >= 56)) continue;
+            sum += values[type * 64 + sq];
+            ++squares;
+        }
+        material[type] = type == 5 ? 0 : static_cast<int>(std::lround(sum / squares));
+    }
+
+    out << "constexpr int " << prefix << "_value[6] = {";
+    for (int type = 0; type < 6; ++type) out << (type ? ", " : " ") << material[type];
+    out << " };\n\n";
+
+    for (int type = 0; type < 6; ++type) {
+        out << "constexpr int " << prefix << "_" << names[type] << "_table[64] = {\n";
+        for (int row = 0; row < 8; ++row) {
+            out << "   ";
+            for (int file = 0; file < 8; ++file) {
+                int sq = row * 8 + file;
+                bool unused = type == 0 && (sq < 8 || sq >= 56);
+                int value = unused ? 0 : static_cast<int>(std::lround(values[type * 64 + sq])) - material[type];
+                out << " " << std::setw(4) << value << ",";
+            }
+            out << "\n";
+        }
+        out << "};\n\n";
+    }
+}
+
+bool write_header(const std::string& path, const std::vector<double>& params, double k, size_t positions,
+                  double final_loss) {
+    std::ofstream out(path);
+    if (!out) return false;
+    out << "#ifndef PESTO_TUNED_HPP\n#define PESTO_TUNED_HPP\n\n"
+        << "// Generated by lumin tune from " << positions << " positions (K = "
+        << std::fixed << std::setprecision(4) << k << ", loss = " << std::setprecision(6) << final_loss << ").\n"
+        << "// Same layout as the tables in Evaluation/pestoeval.cpp.\n\n"
+        << "namespace PestoTuned {\n\n";
+    write_tables(out, "mg", params.data());
+    write_tables(out, "eg", params.data() + TABLE_SIZE);
+    out << "} // namespace PestoTuned\n\n#endif // PESTO_TUNED_HPP\n";
+    return static_cast<bool>(out);
+}
+
+void print_tune_usage() {
+    std::cerr << "Usage: lumin tune --data <file> [--epochs N] [--lr F] [--k K] [--lambda L]"
+                 " [--threads T] [--limit N] [--out <header>]\n";
+}
+
+} // namespace
+
+//----------------------------------------------------------------------
+// lumin tune
+//----------------------------------------------------------------------
+
+int tune_main(const std::vector<std::string>& args) {
+    std::string data_path, out_path = "pesto_tuned.hpp";
+    int epochs = 500;
+    double lr = 1.0, k = 0.0, lambda = 1.0;
+    size_t limit = SIZE_MAX;
+    int threads = std::max(1u, std::thread::hardware_concurrency());
+
+    for (size_t i = 0; i < args.size(); ++i) {
+        const std::string& arg = args[i];
+        bool has_value = i + 1 < args.size();
+        if      (arg == "--data" && has_value)    data_path = args[++i];
+        else if (arg == "--out" && has_value)     out_path = args[++i];
+        else if (arg == "--epochs" && has_value)  epochs = std::atoi(args[++i].c_str());
+        else if (arg == "--lr" && has_value)      lr = std::atof(args[++i].c_str());
+        else if (arg == "--k" && has_value)       k = std::atof(args[++i].c_str());
+        else if (arg == "--lambda" && has_value)  lambda = std::atof(args[++i].c_str());
+        else if (arg == "--threads" && has_value) threads = std::atoi(args[++i].c_str());
+        else if (arg == "--limit" && has_value)   limit = std::strtoull(args[++i].c_str(), nullptr, 10);
+        else {
+            print_tune_usage();
+            return 1;
+        }
+    }
+    if (data_path.empty() || epochs < 0 || lr <= 0.0 || lambda < 0.0 || lambda > 1.0) {
+        print_tune_usage();
+        return 1;
+    }
+    threads = std::clamp(threads, 1, SearchStats::MAX_THREADS);
+
+    Datagen::DataFile file;
+    if (!file.open(data_path)) {
+        std::cerr << "Cannot map " << data_path << " as a data file\n";
+        return 1;
+    }
+
+    auto t0 = std::chrono::steady_clock::now();
+    auto seconds_since_start = [&]() {
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+    };
+    TuneSet set = load_set(file, limit, threads);
+    std::cerr << "Loaded " << set.size() << " positions (" << set.coefficients.size() << " coefficients) in "
+              << std::fixed << std::setprecision(1) << seconds_since_start() << " s\n";
+
+    std::vector<double> params = initial_params();
+    if (k <= 0.0) k = fit_k(set, params, lambda, threads);
+    std::cerr << "K = " << std::setprecision(4) << k << ", starting loss "
+              << std::setprecision(6) << loss(set, params, k, lambda, threads) << "\n";
+
+    // Adam, one full-batch step per epoch
+    const double beta1 = 0.9, beta2 = 0.999, epsilon = 1e-8;
+    std::vector<double> grad(PARAMS), m(PARAMS, 0.0), v(PARAMS, 0.0);
+    double current = 0.0;
+    for (int epoch = 1; epoch <= epochs; ++epoch) {
+        current = gradient(set, params, k, lambda, threads, grad);
+        double correction1 = 1.0 - std::pow(beta1, epoch), correction2 = 1.0 - std::pow(beta2, epoch);
+        for (int p = 0; p < PARAMS; ++p) {
+            m[p] = beta1 * m[p] + (1.0 - beta1) * grad[p];
+            v[p] = beta2 * v[p] + (1.0 - beta2) * grad[p] * grad[p];
+            params[p] -= lr * (m[p] / correction1) / (std::sqrt(v[p] / correction2) + epsilon);
+        }
+        if (epoch % 50 == 0 || epoch == epochs) {
+            std::cerr << "Epoch " << epoch << ": loss " << std::setprecision(6) << current << " ("
+                      << std::setprecision(1) << seconds_since_start() << " s)\n";
+        }
+    }
+
+    double final_loss = loss(set, params, k, lambda, threads);
+    if (!write_header(out_path, params, k, set.size(), final_loss)) {
+        std::cerr << "Cannot write " << out_path << "\n";
+        return 1;
+    }
+    std::cerr << "Final loss " << std::setprecision(6) << final_loss << ", tables written to " << out_path << "\n";
+    return 0;
+}
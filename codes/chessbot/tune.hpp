@@ -0,0 +1,21 @@
+#ifndef TUNE_HPP
+#define TUNE_HPP
+
+#include <string>
+#include <vector>
+
+// lumin tune --data <file> [--epochs N] [--lr F] [--k K] [--lambda L]
+//            [--threads T] [--limit N] [--out <header>]
+//
+// Texel tuning of the PeSTO material and piece-square values over a
+// datagen file. Every position is reduced once, when the file is loaded,
+// to its game phase and a list of (piece, square, +-1) coefficients: the
+// evaluation is linear in the table entries, so each Adam step evaluates
+// and differentiates the whole set from these lists alone, split across
+// T threads. K, the scale of the sigmoid, is fitted to the starting
+// tables unless given. The target is lambda * result + (1 - lambda) *
+// sigmoid(search score). The tuned tables are written as a header in the
+// layout of pestoeval.cpp. Returns the process exit code.
+int tune_main(const std::vector<std::string>& args);
+
+#endif // TUNE_HPP
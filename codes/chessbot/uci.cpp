@@ -1,7 +1,22 @@
 #include "uci.hpp"
 #include "position.hpp"
 #include "movedef.hpp"
+#include "search.hpp"
+#include "tt.hpp"
+#include "book.hpp"
+#include "bitbase.hpp"
+#include "mate.hpp"
+#include "mcts.hpp"
+#include "attacks.hpp"
 #include <iostream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <chrono>
+#include <algorithm>
+#include <cctype>
+#include <memory>
+#include <vector>
 
 /*
     Example UCI commands to init position on chess board
@@ -39,8 +54,8 @@ Move parse_move(const std::string& move_str, Position position) {
     for (Move mv : position.move_list) {
         if (source_square == get_move_source(mv) && target_square == get_move_target(mv)){
             int promoted = get_move_promoted(mv);
-            // Handle promotions
-            if (promoted) {
+            // Handle promotions (non-promotions store the moving piece here)
+            if (promoted != get_move_piece(mv)) {
                 if (move_str.size() == 5) {
                     char promo_char = std::tolower(move_str[4]);
                     if ((promoted == wQ || promoted == bQ) && promo_char == 'q')
@@ -51,11 +66,11 @@ Move parse_move(const std::string& move_str, Position position) {
                         return mv;
                     if ((promoted == wN || promoted == bN) && promo_char == 'n')
                         return mv;
+                    // Wrong promotion piece requested, skip this move
+                    continue;
                 }
-                // Wrong promotion piece requested, skip this move
-                else{
-                    return mv;
-                }
+                // No piece given: default to the first (queen) promotion
+                return mv;
             }
 
             // Non-promotion moves match
@@ -65,4 +80,369 @@ Move parse_move(const std::string& move_str, Position position) {
 
     // No matching legal move found
     return 0;
-}
\ No newline at end of file
+}
+
+std::string move_to_uci(Move mv) {
+    if (!mv) return "0000";
+
+    std::string str = std::string(square_to_coordinates[get_move_source(mv)])
+                    + square_to_coordinates[get_move_target(mv)];
+
+    int piece = get_move_piece(mv);
+    int promoted = get_move_promoted(mv);
+    if (promoted != piece) {
+        switch (promoted) {
+            case wQ: case bQ: str += 'q'; break;
+            case wR: case bR: str += 'r'; break;
+            case wB: case bB: str += 'b'; break;
+            case wN: case bN: str += 'n'; break;
+            default: break;
+        }
+    }
+    return str;
+}
+
+//----------------------------------------------------------------------
+// Standard algebraic notation (EPD bm/am fields, PGN)
+//----------------------------------------------------------------------
+
+static const char san_piece_letter[] = "PNBRQKPNBRQK";
+
+static int piece_type(int piece) { return piece % 6; }   // 0 = pawn ... 5 = king
+
+std::string move_to_san(Move mv, Position position) {
+    position.generate_moves();
+
+    int source = get_move_source(mv);
+    int target = get_move_target(mv);
+    int piece = get_move_piece(mv);
+    int promoted = get_move_promoted(mv);
+    bool capture = get_move_capture_flag(mv) || get_move_enpassant(mv);
+    std::string san;
+
+    if (get_move_castling(mv)) {
+        san = (target % 8 == 6) ? "O-O" : "O-O-O";
+    } else if (piece_type(piece) == 0) {
+        if (capture) san += static_cast<char>('a' + source % 8);
+    } else {
+        san += san_piece_letter[piece];
+
+        // Disambiguate against the other pieces of the same kind reaching target
+        bool clash = false, same_file = false, same_rank = false;
+        for (Move other : position.move_list) {
+            int from = get_move_source(other);
+            if (other == mv || from == source || get_move_target(other) != target || get_move_piece(other) != piece) continue;
+            clash = true;
+            same_file |= (from % 8 == source % 8);
+            same_rank |= (from / 8 == source / 8);
+        }
+        if (clash) {
+            if (!same_file)      san += static_cast<char>('a' + source % 8);
+            else if (!same_rank) san += static_cast<char>('8' - source / 8);
+            else                 san += square_to_coordinates[source];
+        }
+    }
+
+    if (!get_move_castling(mv)) {
+        if (capture) san += 'x';
+        san += square_to_coordinates[target];
+        if (promoted != piece) {
+            san += '=';
+            san += san_piece_letter[promoted];
+        }
+    }
+
+    Position next = makemove(mv, position);
+    Color us = next.SideToMove;
+    int king = get_ls1b_index(next.bitboards[us == White ? wK : bK]);
+    if (isSquareAttacked(king, next, us == White ? Black : White)) {
+        next.generate_moves();
+        san += next.move_list.empty() ? '#' : '+';
+    }
+    return san;
+}
+
+// Drop check marks, annotations and '=' so "e8=Q+!" compares equal to "e8Q"
+static std::string normalize_san(const std::string& san) {
+    std::string out;
+    for (char c : san) {
+        if (c == '+' || c == '#' || c == '!' || c == '?' || c == '=') continue;
+        out += (c == '0') ? 'O' : c;
+    }
+    return out;
+}
+
+Move parse_san(const std::string& san, Position position) {
+    position.generate_moves();
+
+    std::string wanted = normalize_san(san);
+    for (Move mv : position.move_list) {
+        if (normalize_san(move_to_san(mv, position)) == wanted) return mv;
+    }
+    return parse_move(san, position);
+}
+
+//----------------------------------------------------------------------
+// UCI loop
+//
+// Commands are read on the calling thread; "go" runs the search on its own
+// thread so "stop" and "isready" are answered while it thinks.
+//----------------------------------------------------------------------
+
+static constexpr int MAX_HASH_MB = 4096;
+static constexpr int MAX_THREADS = SearchStats::MAX_THREADS;
+static constexpr int MAX_MULTI_PV = 256;
+
+static std::thread search_thread;
+
+// MCTS tree kept from one "go" to the next (each runs on a new thread)
+static Mcts::Tree mcts_tree;
+
+// UCI option "OwnBook": probe `book` before searching
+static bool own_book = true;
+
+static void wait_for_search() {
+    if (search_thread.joinable()) search_thread.join();
+}
+
+static void stop_search() {
+    time_manager.request_stop();
+    wait_for_search();
+}
+
+// position [startpos | fen <fen>] [moves <m1> <m2> ...]
+static void parse_position(std::istringstream& iss, Position& position) {
+    std::string token;
+    iss >> token;
+
+    if (token == "startpos") {
+        position = Position();
+        iss >> token;                       // "moves" or nothing
+    } else if (token == "fen") {
+        std::string fen;
+        while (iss >> token && token != "moves") fen += token + " ";
+        Position parsed;
+        FenError error = parse_fen(fen, parsed);
+        if (error != FenError::None) {
+            std::cout << "info string invalid fen (" << fen_error_string(error) << ")" << std::endl;
+            return;
+        }
+        position = parsed;
+    }
+
+    if (token != "moves") return;
+
+    while (iss >> token) {
+        Move mv = parse_move(token, position);
+        if (!mv) break;
+        position = makemove(mv, position);
+    }
+}
+
+// "go mate N": shortest mate in at most N moves from the df-pn solver, with
+// a normal search within the remaining limits as a fallback when none is
+// found. Returns the best move and sets `ponder` to the expected reply.
+static Move mate_search(const Position& position, const SearchLimits& limits, Move& ponder) {
+    // Allocated on the first "go mate" only
+    static std::unique_ptr<MateSolver> solver;
+    if (!solver) solver = std::make_unique<MateSolver>();
+
+    SearchStats::bind_thread(0);
+    SearchStats::reset_counters();
+    time_manager.start(limits, position.SideToMove);
+    MateResult result = solver->solve(position, limits.mate, time_manager, [](int moves, const MateResult& found) {
+        int64_t elapsed = time_manager.elapsed_ms();
+        uint64_t nodes = SearchStats::get_positions_searched();
+        std::cout << "info depth " << (found.moves ? 2 * moves - 1 : 2 * moves);
+        if (found.moves) std::cout << " score mate " << moves;
+        std::cout << " nodes " << nodes << " nps " << (elapsed > 0 ? nodes * 1000 / elapsed : nodes)
+                  << " time " << elapsed;
+        if (found.moves) {
+            std::cout << " pv";
+            for (Move m : found.pv) std::cout << ' ' << move_to_uci(m);
+        }
+        std::cout << std::endl;
+    });
+    SearchStats::finish();
+
+    ponder = result.pv.size() > 1 ? result.pv[1] : 0;
+    if (!result.pv.empty()) return result.pv[0];
+
+    std::cout << "info string " << (result.disproved ? "no mate in " + std::to_string(limits.mate) : "no mate found")
+              << std::endl;
+
+    // Whatever budget the solver left goes to a normal search. With no
+    // budget at all, search as far as the mate horizon that was asked for.
+    SearchLimits rest = limits;
+    rest.mate = 0;
+    int64_t elapsed = time_manager.elapsed_ms();
+    uint64_t nodes = SearchStats::get_positions_searched();
+    Color us = position.SideToMove;
+    if (rest.movetime > 0) rest.movetime = static_cast<int>(std::max<int64_t>(1, rest.movetime - elapsed));
+    if (rest.time[us] > 0) rest.time[us] = static_cast<int>(std::max<int64_t>(1, rest.time[us] - elapsed));
+    if (rest.nodes > 0) rest.nodes = rest.nodes > nodes ? rest.nodes - nodes : 1;
+    if (!rest.infinite && !rest.depth && !rest.nodes && !rest.movetime && rest.time[us] <= 0)
+        rest.depth = 2 * limits.mate;
+
+    Move best = findbestmove(position, rest, SearchOutput::Uci);
+    std::vector<Move> pv = extract_pv(position, best, 2);
+    ponder = pv.size() > 1 ? pv[1] : 0;
+    return best;
+}
+
+// go [depth N] [nodes N] [movetime N] [wtime N] [btime N] [winc N] [binc N] [movestogo N] [mate N] [infinite] [ponder]
+static void parse_go(std::istringstream& iss, const Position& position) {
+    SearchLimits limits;
+    std::string token;
+
+    while (iss >> token) {
+        if      (token == "depth")     iss >> limits.depth;
+        else if (token == "nodes")     iss >> limits.nodes;
+        else if (token == "movetime")  iss >> limits.movetime;
+        else if (token == "wtime")     iss >> limits.time[White];
+        else if (token == "btime")     iss >> limits.time[Black];
+        else if (token == "winc")      iss >> limits.inc[White];
+        else if (token == "binc")      iss >> limits.inc[Black];
+        else if (token == "movestogo") iss >> limits.movestogo;
+        else if (token == "mate")      iss >> limits.mate;
+        else if (token == "infinite")  limits.infinite = true;
+        else if (token == "ponder")    limits.ponder = true;
+    }
+
+    stop_search();
+    time_manager.clear_stop_request();
+
+    // Book moves are answered at once, unless the GUI expects us to think until told
+    if (own_book && !limits.infinite && !limits.ponder) {
+        if (Move mv = book.probe(position)) {
+            std::cout << "info string book move\nbestmove " << move_to_uci(mv) << std::endl;
+            return;
+        }
+    }
+
+    search_thread = std::thread([position, limits]() {
+        SearchContext context;
+        context.tree = &mcts_tree;
+        set_search_context(context);
+
+        Move best, ponder = 0;
+        if (limits.mate > 0) {
+            best = mate_search(position, limits, ponder);
+        } else {
+            best = findbestmove(position, limits, SearchOutput::Uci);
+            // Suggest the expected reply so the GUI can let us ponder on it
+            std::vector<Move> pv = extract_pv(position, best, 2);
+            if (pv.size() > 1) ponder = pv[1];
+        }
+
+        // "go infinite" and "go ponder" must not answer before "stop" / "ponderhit"
+        while (!time_manager.is_stop_requested() && (limits.infinite || time_manager.is_pondering())) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+
+        std::string line = "bestmove " + move_to_uci(best);
+        if (ponder) line += " ponder " + move_to_uci(ponder);
+        std::cout << line + "\n" << std::flush;
+    });
+}
+
+static void parse_setoption(std::istringstream& iss) {
+    std::string token, name, value;
+
+    iss >> token;                                   // "name"
+    while (iss >> token && token != "value") name += (name.empty() ? "" : " ") + token;
+    std::getline(iss >> std::ws, value);            // paths may contain spaces
+
+    std::transform(name.begin(), name.end(), name.begin(), ::tolower);
+
+    if (name == "hash") {
+        int mb = std::clamp(std::atoi(value.c_str()), 1, MAX_HASH_MB);
+        stop_search();
+        tt.resize(mb);
+    } else if (name == "threads") {
+        search_threads = std::clamp(std::atoi(value.c_str()), 1, MAX_THREADS);
+    } else if (name == "multipv") {
+        multi_pv = std::clamp(std::atoi(value.c_str()), 1, MAX_MULTI_PV);
+    } else if (name == "ownbook") {
+        own_book = (value == "true");
+    } else if (name == "bookfile") {
+        if (value.empty() || value == "<empty>") book.close();
+        else if (!book.open(value)) std::cout << "info string cannot open book " << value << std::endl;
+        else std::cout << "info string book " << value << " (" << book.size() << " entries)" << std::endl;
+    } else if (name == "searchalgorithm") {
+        stop_search();
+        if (!parse_search_algorithm(value, active_search))
+            std::cout << "info string unknown search algorithm " << value << std::endl;
+    } else if (name == "bitbasepath") {
+        stop_search();
+        if (value.empty() || value == "<empty>") Bitbase::unload();
+        else std::cout << "info string " << Bitbase::load(value) << " bitbases in " << value << std::endl;
+    }
+}
+
+// "savehash <file>" / "loadhash <file>": keep the TT across sessions
+static void hash_file_command(std::istringstream& iss, bool save) {
+    std::string path;
+    std::getline(iss >> std::ws, path);
+    if (path.empty()) {
+        std::cout << "info string usage: " << (save ? "savehash" : "loadhash") << " <file>" << std::endl;
+        return;
+    }
+    stop_search();
+    if (save && tt.save(path))
+        std::cout << "info string saved " << tt.size_mb() << " MB hash to " << path << std::endl;
+    else if (!save && tt.load(path))
+        std::cout << "info string loaded " << tt.size_mb() << " MB hash from " << path << std::endl;
+    else
+        std::cout << "info string cannot " << (save ? "save hash to " : "load hash from ") << path << std::endl;
+}
+
+// Returns false on "quit"
+static bool handle_command(const std::string& line, Position& position) {
+    std::istringstream iss(line);
+    std::string token;
+    iss >> token;
+
+    if (token == "uci") {
+        std::cout << "id name " << NAME << "\n"
+                  << "id author Lumin developers\n"
+                  << "option name Hash type spin default " << TranspositionTable::DEFAULT_MB
+                  << " min 1 max " << MAX_HASH_MB << "\n"
+                  << "option name Threads type spin default 1 min 1 max " << MAX_THREADS << "\n"
+                  << "option name Ponder type check default false\n"
+                  << "option name MultiPV type spin default 1 min 1 max " << MAX_MULTI_PV << "\n"
+                  << "option name OwnBook type check default true\n"
+                  << "option name BookFile type string default "
+                  << (book.is_open() ? book.path() : "<empty>") << "\n"
+                  << "option name SearchAlgorithm type combo default " << search_algorithm_name(active_search)
+                  << " var alphabeta var mcts\n"
+                  << "option name BitbasePath type string default "
+                  << (Bitbase::directory().empty() ? "<empty>" : Bitbase::directory()) << "\n"
+                  << "uciok" << std::endl;
+    }
+    else if (token == "isready")    std::cout << "readyok" << std::endl;
+    else if (token == "ucinewgame") { stop_search(); tt.clear(); mcts_tree.clear(); position = Position(); }
+    else if (token == "position")   { stop_search(); parse_position(iss, position); }
+    else if (token == "go")         parse_go(iss, position);
+    else if (token == "stop")       stop_search();
+    else if (token == "ponderhit")  time_manager.ponderhit();
+    else if (token == "setoption")  parse_setoption(iss);
+    else if (token == "savehash")   hash_file_command(iss, true);
+    else if (token == "loadhash")   hash_file_command(iss, false);
+    else if (token == "d")          { position.print(); std::cout << "Fen: " << position.get_fen() << std::endl; }
+    else if (token == "quit")       return false;
+
+    return true;
+}
+
+void uci_loop(const std::string& first_command) {
+    Position position;
+    std::string line;
+
+    bool running = first_command.empty() || handle_command(first_command, position);
+    while (running && std::getline(std::cin, line)) {
+        running = handle_command(line, position);
+    }
+
+    stop_search();
+}
@@ -2,9 +2,24 @@
 #define UCI_HPP
 
 #include <iostream>
+#include <string>
 #include "movedef.hpp"
 #include "position.hpp"
 
 Move parse_move(const std::string& move_str, Position position);
 
-#endif
\ No newline at end of file
+// Long algebraic notation used by UCI ("e2e4", "e7e8q")
+std::string move_to_uci(Move mv);
+
+// Standard algebraic notation ("Nbd7", "exd5", "O-O", "e8=Q+") of a legal
+// move of `position`
+std::string move_to_san(Move mv, Position position);
+// Legal move of `position` written in SAN (check marks and annotations are
+// optional) or in UCI notation; 0 if there is none
+Move parse_san(const std::string& san, Position position);
+
+// Read UCI commands from stdin until "quit", after running first_command
+// (for callers that already consumed the GUI's "uci")
+void uci_loop(const std::string& first_command = "");
+
+#endif
@@ -0,0 +1,22 @@
+#include "zobrist.hpp"
+#include "position.hpp"
+#include "bitboard.hpp"
+
+U64 generate_hash_key(const Position& position) {
+    U64 key = 0ULL;
+
+    for (int p = wP; p <= bK; ++p) {
+        U64 bb = position.bitboards[p];
+        while (bb) {
+            int sq = get_ls1b_index(bb);
+            key ^= Zobrist::keys.pieces[p][sq];
+            pop_bit(bb, sq);
+        }
+    }
+
+    if (position.enpassant != no_sq) key ^= Zobrist::keys.enpassant[position.enpassant];
+    key ^= Zobrist::keys.castling[position.castling & 15];
+    if (position.SideToMove == Black) key ^= Zobrist::keys.side;
+
+    return key;
+}
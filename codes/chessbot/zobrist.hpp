@@ -0,0 +1,49 @@
+#ifndef ZOBRIST_HPP
+#define ZOBRIST_HPP
+
+#include <array>
+#include "types.hpp"
+
+struct Position;
+
+//----------------------------------------------------------------------
+// Zobrist keys, generated at compile time (splitmix64, fixed seed) so
+// every Position can be hashed without an init call.
+//----------------------------------------------------------------------
+
+namespace Zobrist {
+    constexpr U64 splitmix64(U64& state) {
+        U64 z = (state += 0x9E3779B97F4A7C15ULL);
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+        return z ^ (z >> 31);
+    }
+
+    struct Keys {
+        U64 pieces[12][64] = {};
+        U64 enpassant[64] = {};
+        U64 castling[16] = {};
+        U64 side = 0;
+    };
+
+    constexpr Keys make_keys() {
+        Keys keys{};
+        U64 state = 0x4C756D696E2D3130ULL;
+        for (int p = 0; p < 12; ++p)
+            for (int sq = 0; sq < 64; ++sq)
+                keys.pieces[p][sq] = splitmix64(state);
+        for (int sq = 0; sq < 64; ++sq)
+            keys.enpassant[sq] = splitmix64(state);
+        for (int c = 0; c < 16; ++c)
+            keys.castling[c] = splitmix64(state);
+        keys.side = splitmix64(state);
+        return keys;
+    }
+
+    inline constexpr Keys keys = make_keys();
+}
+
+// Hash a position from scratch (makemove updates the key incrementally)
+U64 generate_hash_key(const Position& position);
+
+#endif // ZOBRIST_HPP